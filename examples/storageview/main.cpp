@@ -43,12 +43,18 @@
 #include <QtWidgets/QHeaderView>
 #include <QtWidgets/QTreeView>
 
+#include <QStorageInfo>
+
 #include "storagemodel.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    // a network filesystem whose server is gone must not keep a row
+    // loading forever
+    QStorageInfo::setQueryTimeout(5000);
+
     QTreeView view;
     view.setModel(new StorageModel(&view));
     view.resize(640, 480);
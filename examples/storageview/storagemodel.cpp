@@ -41,29 +41,84 @@
 
 #include "storagemodel.h"
 
+#include <QBrush>
 #include <QDir>
-#include <qmath.h>
+#include <QStorageWatcher>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+static const int defaultRefreshInterval = 5000;
+static const int fetchBatchSize = 256;
+
+static int bitLength(quint64 value)
+{
+    int result = 0;
+    for (int shift = 32; shift > 0; shift /= 2) {
+        if (value >> shift) {
+            value >>= shift;
+            result += shift;
+        }
+    }
+    return result + int(value);
+}
 
 static QString sizeToString(qint64 size)
 {
-    static const char *const strings[] = { "b", "kB", "MB", "GB", "TB", "PB", "EB", "ZB", "YB" };
+    static const char *const strings[] = { "b", "kB", "MB", "GB", "TB", "PB", "EB" };
 
     if (size <= 0)
         return StorageModel::tr("0 b");
 
-    double power = log((double)size)/log(1024.0);
-    int intPower = (int)power;
-    intPower = intPower >= 8 ? 8 - 1 : intPower;
+    // the largest power of 1024 not above size, without floating point math
+    const int power = (bitLength(quint64(size)) - 1) / 10;
+    if (power == 0)
+        return StorageModel::tr("%1 %2").arg(size).arg(QLatin1String(strings[0]));
 
-    double normSize = size / pow(1024.0, intPower);
+    // size in 1024ths of the unit, which is below 2^20 and leaves enough room
+    // to round to hundredths
+    const quint64 fraction = quint64(size) >> (10 * power - 10);
+    const quint64 hundredths = (fraction * 100 + 512) >> 10;
+    const QString number = QStringLiteral("%1.%2").arg(hundredths / 100)
+            .arg(hundredths % 100, 2, 10, QLatin1Char('0'));
     //: this should expand to "1.23 GB"
-    return StorageModel::tr("%1 %2").arg(normSize, 0, 'f', intPower > 0 ? 2 : 0).arg(strings[intPower]);
+    return StorageModel::tr("%1 %2").arg(number).arg(QLatin1String(strings[power]));
+}
+
+// only reads the mount table, the volumes are queried row by row
+static QStorageSnapshot currentSnapshot()
+{
+    return QStorageSnapshot::current(QStorageInfo::SkipVolumeInfo);
 }
 
 StorageModel::StorageModel(QObject *parent) :
     QAbstractTableModel(parent),
-    m_volumes(QStorageInfo::mountedVolumes())
+    m_rowCount(0),
+    m_timer(new QTimer(this)),
+    m_refreshPending(false)
 {
+    connect(&m_refreshWatcher, SIGNAL(finished()), this, SLOT(snapshotReady()));
+    connect(&m_queryWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(volumeQueried(int)));
+    connect(&m_queryWatcher, SIGNAL(finished()), this, SLOT(startQueries()));
+
+    // the model starts out empty and is filled from a worker thread
+    refresh();
+
+#if defined(Q_OS_LINUX)
+    // The kernel reports mounts and unmounts, so they are shown right away.
+    // Elsewhere the watcher would only poll, which the timer below already
+    // does without touching the GUI thread.
+    QStorageWatcher *watcher = new QStorageWatcher(this);
+    connect(watcher, SIGNAL(volumeMounted(QStorageInfo)), this, SLOT(refresh()));
+    connect(watcher, SIGNAL(volumeUnmounted(QStorageInfo)), this, SLOT(refresh()));
+    connect(watcher, SIGNAL(volumeChanged(QStorageInfo)), this, SLOT(refresh()));
+#endif
+
+    // the space is polled, along with the mounts on other platforms
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    m_timer->start(defaultRefreshInterval);
 }
 
 int StorageModel::columnCount(const QModelIndex &/*parent*/) const
@@ -75,7 +130,29 @@ int StorageModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
         return 0;
-    return m_volumes.count();
+    return m_rowCount;
+}
+
+bool StorageModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_rowCount < m_volumes.size();
+}
+
+// Shows the next batch of volumes with what the mount table says about them
+// and queries their space in the background.
+void StorageModel::fetchMore(const QModelIndex &parent)
+{
+    const int count = parent.isValid() ? 0 : qMin(fetchBatchSize, m_volumes.size() - m_rowCount);
+    if (count <= 0)
+        return;
+
+    beginInsertRows(QModelIndex(), m_rowCount, m_rowCount + count - 1);
+    m_rowCount += count;
+    endInsertRows();
+
+    for (int row = m_rowCount - count; row < m_rowCount; ++row)
+        m_queryQueue.append(m_volumes.at(row).info);
+    startQueries();
 }
 
 QVariant StorageModel::data(const QModelIndex &index, int role) const
@@ -84,62 +161,52 @@ QVariant StorageModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     if (role == Qt::DisplayRole) {
-        const QStorageInfo &volume = m_volumes.at(index.row());
-        switch (index.column()) {
-        case ColumnRootPath:
-            return QDir::toNativeSeparators(volume.rootPath());
-        case ColumnName:
-            return volume.name();
-        case ColumnDevice:
-            return volume.device();
-        case ColumnFileSystemName:
-            return volume.fileSystemType();
-        case ColumnTotal:
-            return sizeToString(volume.bytesTotal());
-        case ColumnFree:
-            return sizeToString(volume.bytesFree());
-        case ColumnAvailable:
-            return sizeToString(volume.bytesAvailable());
-        case ColumnIsReady:
-            return volume.isReady();
-        case ColumnIsReadOnly:
-            return volume.isReadOnly();
-        case ColumnIsValid:
-            return volume.isValid();
-        default:
-            break;
-        }
+        return displayData(m_volumes.at(index.row()), index.column());
+    } else if (role == LoadingRole) {
+        return m_volumes.at(index.row()).loading;
+    } else if (role == Qt::ForegroundRole) {
+        if (m_volumes.at(index.row()).loading)
+            return QBrush(Qt::gray);
     } else if (role == Qt::ToolTipRole) {
-        const QStorageInfo &volume = m_volumes.at(index.row());
-        return tr("Root path : %1\n"
-                  "Name: %2\n"
-                  "Display Name: %3\n"
-                  "Device: %4\n"
-                  "FileSystem: %5\n"
-                  "Total size: %6\n"
-                  "Free size: %7\n"
-                  "Available size: %8\n"
-                  "Is Ready: %9\n"
-                  "Is Read-only: %10\n"
-                  "Is Valid: %11\n"
-                  "Is Root: %12"
-                  ).
-                arg(QDir::toNativeSeparators(volume.rootPath())).
-                arg(volume.name()).
-                arg(volume.displayName()).
-                arg(QString::fromUtf8(volume.device())).
-                arg(QString::fromUtf8(volume.fileSystemType())).
-                arg(sizeToString(volume.bytesTotal())).
-                arg(sizeToString(volume.bytesFree())).
-                arg(sizeToString(volume.bytesAvailable())).
-                arg(volume.isReady() ? tr("true") : tr("false")).
-                arg(volume.isReadOnly() ? tr("true") : tr("false")).
-                arg(volume.isValid() ? tr("true") : tr("false")).
-                arg(volume.isRoot() ? tr("true") : tr("false"));
+        const Volume &volume = m_volumes.at(index.row());
+        if (volume.loading)
+            return tr("Querying %1...").arg(volume.nativeRootPath);
+        if (volume.toolTip.isEmpty())
+            volume.toolTip = toolTip(volume);
+        return volume.toolTip;
     }
     return QVariant();
 }
 
+QString StorageModel::toolTip(const Volume &volume)
+{
+    return tr("Root path : %1\n"
+              "Name: %2\n"
+              "Display Name: %3\n"
+              "Device: %4\n"
+              "FileSystem: %5\n"
+              "Total size: %6\n"
+              "Free size: %7\n"
+              "Available size: %8\n"
+              "Is Ready: %9\n"
+              "Is Read-only: %10\n"
+              "Is Valid: %11\n"
+              "Is Root: %12"
+              ).
+            arg(volume.nativeRootPath).
+            arg(volume.name).
+            arg(volume.displayName).
+            arg(QString::fromUtf8(volume.device)).
+            arg(QString::fromUtf8(volume.fileSystemType)).
+            arg(volume.total).
+            arg(volume.free).
+            arg(volume.available).
+            arg(volume.isReady ? tr("true") : tr("false")).
+            arg(volume.isReadOnly ? tr("true") : tr("false")).
+            arg(volume.isValid ? tr("true") : tr("false")).
+            arg(volume.isRoot ? tr("true") : tr("false"));
+}
+
 QVariant StorageModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation != Qt::Horizontal)
@@ -175,3 +242,247 @@ QVariant StorageModel::headerData(int section, Qt::Orientation orientation, int
 
     return QVariant();
 }
+
+int StorageModel::refreshInterval() const
+{
+    return m_timer->isActive() ? m_timer->interval() : 0;
+}
+
+// A value of 0 turns polling off; mounts and unmounts are still noticed.
+void StorageModel::setRefreshInterval(int msecs)
+{
+    if (msecs > 0)
+        m_timer->start(msecs);
+    else
+        m_timer->stop();
+}
+
+// Reads the mount table on a worker thread and then queries the space of
+// the visible volumes again. Requests made meanwhile are merged into one.
+void StorageModel::refresh()
+{
+    if (m_refreshWatcher.isRunning()) {
+        m_refreshPending = true;
+        return;
+    }
+    m_refreshWatcher.setFuture(QtConcurrent::run(currentSnapshot));
+}
+
+void StorageModel::snapshotReady()
+{
+    update(m_refreshWatcher.result());
+
+    // while a batch is still running, its results are recent enough
+    if (!m_queryWatcher.isRunning()) {
+        for (int row = 0; row < m_rowCount; ++row)
+            m_queryQueue.append(m_volumes.at(row).info);
+        startQueries();
+    }
+
+    if (m_refreshPending) {
+        m_refreshPending = false;
+        refresh();
+    }
+}
+
+// Queries the queued volumes on the thread pool, one batch at a time. Each
+// row is updated as soon as its volume answers.
+void StorageModel::startQueries()
+{
+    if (m_queryWatcher.isRunning() || m_queryQueue.isEmpty())
+        return;
+
+    m_queryWatcher.setFuture(QtConcurrent::mapped(m_queryQueue, &StorageModel::queryVolume));
+    m_queryQueue.clear();
+}
+
+void StorageModel::volumeQueried(int index)
+{
+    const Volume queried = m_queryWatcher.resultAt(index);
+    const int row = m_rows.value(queried.key, -1);
+    if (row != -1)
+        setVolume(row, queried);
+}
+
+// Runs on a worker thread.
+StorageModel::Volume StorageModel::queryVolume(const QStorageInfo &info)
+{
+    QStorageInfo volume = info;
+    volume.refreshSpace();
+
+    Volume result = mountedVolume(volume);
+    result.loading = false;
+    result.name = volume.name();
+    result.displayName = volume.displayName();
+    if (volume.hasTimedOut()) {
+        result.total = result.free = result.available = tr("Not responding");
+    } else {
+        result.total = sizeToString(volume.bytesTotal());
+        result.free = sizeToString(volume.bytesFree());
+        result.available = sizeToString(volume.bytesAvailable());
+    }
+    result.isReady = volume.isReady();
+    result.isReadOnly = volume.isReadOnly();
+    result.isValid = volume.isValid();
+    return result;
+}
+
+// Fills in what the mount table knows, which is cheap to get, and marks the
+// rest as still loading.
+StorageModel::Volume StorageModel::mountedVolume(const QStorageInfo &info)
+{
+    Volume result;
+    result.info = info;
+    result.key = QStorageSnapshot::volumeKey(info);
+    result.loading = true;
+    result.nativeRootPath = QDir::toNativeSeparators(info.rootPath());
+    result.device = info.device();
+    result.fileSystemType = info.fileSystemType();
+    result.total = result.free = result.available = tr("Loading...");
+    result.isReady = false;
+    result.isReadOnly = false;
+    result.isValid = false;
+    result.isRoot = info.isRoot();
+    return result;
+}
+
+QVariant StorageModel::displayData(const Volume &volume, int column)
+{
+    switch (column) {
+    case ColumnRootPath:
+        return volume.nativeRootPath;
+    case ColumnName:
+        return volume.name;
+    case ColumnDevice:
+        return volume.device;
+    case ColumnFileSystemName:
+        return volume.fileSystemType;
+    case ColumnTotal:
+        return volume.total;
+    case ColumnFree:
+        return volume.free;
+    case ColumnAvailable:
+        return volume.available;
+    case ColumnIsReady:
+        return volume.loading ? QVariant() : QVariant(volume.isReady);
+    case ColumnIsReadOnly:
+        return volume.loading ? QVariant() : QVariant(volume.isReadOnly);
+    case ColumnIsValid:
+        return volume.loading ? QVariant() : QVariant(volume.isValid);
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+// Applies the differences to the previous snapshot row by row, so that views
+// keep their selection and scroll position. Volumes that were not fetched
+// yet are updated without notifying anyone.
+void StorageModel::update(const QStorageSnapshot &snapshot)
+{
+    const QStorageSnapshot::Diff diff = snapshot.diff(m_snapshot);
+    m_snapshot = snapshot;
+
+    QVector<int> removed;
+    foreach (const QStorageInfo &info, diff.removed) {
+        const int row = m_rows.value(QStorageSnapshot::volumeKey(info), -1);
+        if (row != -1)
+            removed.append(row);
+    }
+    if (!removed.isEmpty()) {
+        // from the bottom up, a range of adjacent rows at a time
+        std::sort(removed.begin(), removed.end());
+        int i = removed.size() - 1;
+        while (i >= 0) {
+            const int last = removed.at(i);
+            int first = last;
+            while (i > 0 && removed.at(i - 1) == first - 1) {
+                --i;
+                --first;
+            }
+            --i;
+            removeVolumes(first, last);
+        }
+        updateRowIndex();
+    }
+
+    foreach (const QStorageInfo &info, diff.changed) {
+        const int row = m_rows.value(QStorageSnapshot::volumeKey(info), -1);
+        if (row == -1)
+            continue;
+
+        // keep the space until the volume has been queried again
+        Volume changed = mountedVolume(info);
+        const Volume &old = m_volumes.at(row);
+        changed.loading = old.loading;
+        changed.name = old.name;
+        changed.displayName = old.displayName;
+        changed.total = old.total;
+        changed.free = old.free;
+        changed.available = old.available;
+        changed.isReady = old.isReady;
+        changed.isReadOnly = old.isReadOnly;
+        changed.isValid = old.isValid;
+        setVolume(row, changed);
+    }
+
+    if (!diff.added.isEmpty()) {
+        // new volumes are shown right away unless there are unfetched ones
+        const bool show = m_rowCount == m_volumes.size();
+        foreach (const QStorageInfo &info, diff.added) {
+            m_rows.insert(QStorageSnapshot::volumeKey(info), m_volumes.size());
+            m_volumes.append(mountedVolume(info));
+        }
+        if (show)
+            fetchMore(QModelIndex());
+    }
+}
+
+void StorageModel::removeVolumes(int first, int last)
+{
+    // the unfetched part goes without notification
+    if (last >= m_rowCount) {
+        const int from = qMax(first, m_rowCount);
+        m_volumes.remove(from, last - from + 1);
+        last = from - 1;
+    }
+    if (last < first)
+        return;
+
+    beginRemoveRows(QModelIndex(), first, last);
+    m_volumes.remove(first, last - first + 1);
+    m_rowCount -= last - first + 1;
+    endRemoveRows();
+}
+
+// Replaces the volume at row and announces the columns that look different.
+void StorageModel::setVolume(int row, const Volume &volume)
+{
+    int firstColumn = -1;
+    int lastColumn = -1;
+    if (row < m_rowCount && m_volumes.at(row).loading != volume.loading) {
+        // the whole row changes its color
+        firstColumn = 0;
+        lastColumn = ColumnCount - 1;
+    } else if (row < m_rowCount) {
+        for (int column = 0; column < ColumnCount; ++column) {
+            if (displayData(m_volumes.at(row), column) != displayData(volume, column)) {
+                if (firstColumn == -1)
+                    firstColumn = column;
+                lastColumn = column;
+            }
+        }
+    }
+
+    m_volumes[row] = volume;
+    if (firstColumn != -1)
+        emit dataChanged(index(row, firstColumn), index(row, lastColumn));
+}
+
+void StorageModel::updateRowIndex()
+{
+    m_rows.clear();
+    m_rows.reserve(m_volumes.size());
+    for (int row = 0; row < m_volumes.size(); ++row)
+        m_rows.insert(m_volumes.at(row).key, row);
+}
@@ -43,7 +43,13 @@
 #define STORAGEMODEL_H
 
 #include <QAbstractTableModel>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QStorageInfo>
+#include <QStorageSnapshot>
+#include <QVector>
+
+class QTimer;
 
 class StorageModel : public QAbstractTableModel
 {
@@ -64,16 +70,72 @@ public:
         ColumnCount
     };
 
+    enum Role {
+        LoadingRole = Qt::UserRole // true while the volume is being queried
+    };
+
     explicit StorageModel(QObject *parent = 0);
 
     int columnCount(const QModelIndex &parent) const;
     int rowCount(const QModelIndex &parent) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
 
     QVariant data(const QModelIndex &index, int role) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
 
+    int refreshInterval() const;
+    void setRefreshInterval(int msecs);
+
+public slots:
+    void refresh();
+
+private slots:
+    void snapshotReady();
+    void startQueries();
+    void volumeQueried(int index);
+
 private:
-    QList<QStorageInfo> m_volumes;
+    // what the rows show, as of the last refresh, formatted once per change
+    struct Volume
+    {
+        QStorageInfo info;
+        QByteArray key;
+        bool loading;
+        QString nativeRootPath;
+        QString name;
+        QString displayName;
+        QByteArray device;
+        QByteArray fileSystemType;
+        QString total;
+        QString free;
+        QString available;
+        bool isReady;
+        bool isReadOnly;
+        bool isValid;
+        bool isRoot;
+        mutable QString toolTip; // built when first shown
+    };
+
+    static Volume mountedVolume(const QStorageInfo &info);
+    static Volume queryVolume(const QStorageInfo &info);
+    static QString toolTip(const Volume &volume);
+    static QVariant displayData(const Volume &volume, int column);
+    void update(const QStorageSnapshot &snapshot);
+    void removeVolumes(int first, int last);
+    void setVolume(int row, const Volume &volume);
+    void updateRowIndex();
+
+    // all known volumes, of which the first m_rowCount are fetched rows
+    QVector<Volume> m_volumes;
+    int m_rowCount;
+    QHash<QByteArray, int> m_rows;
+    QStorageSnapshot m_snapshot;
+    QFutureWatcher<QStorageSnapshot> m_refreshWatcher;
+    QFutureWatcher<Volume> m_queryWatcher;
+    QList<QStorageInfo> m_queryQueue;
+    QTimer *m_timer;
+    bool m_refreshPending;
 };
 
 #endif // STORAGEMODEL_H
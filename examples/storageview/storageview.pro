@@ -1,5 +1,5 @@
 TEMPLATE = app
-QT += core gui widgets
+QT += core gui widgets concurrent
 DESTDIR = ../../bin
 
 HEADERS += storagemodel.h
@@ -33,6 +33,16 @@
 
 #include "qstorageinfo.h"
 #include "qstorageinfo_p.h"
+#include "qstoragestatistics_p.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qfutureinterface.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qset.h>
+#include <QtCore/qsharedpointer.h>
+#include <QtCore/qthreadpool.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -54,7 +64,14 @@ QT_BEGIN_NAMESPACE
     list of all mounted filesystems.
 
     QStorageInfo always caches the retrieved information, but you can call
-    refresh() to invalidate the cache.
+    refresh() to invalidate the cache. On Unix systems, all QStorageInfo
+    objects that refer to the same mounted volume share that cache, so
+    refreshing any of them updates all of them.
+
+    On Unix systems, creating a QStorageInfo object only looks up the mount
+    point of the volume. The space information and the read-only flag are
+    retrieved the first time one of them is accessed, and the label the first
+    time name(), uuid() or partitionUuid() is called.
 
     The following example retrieves the most common information about the root
     volume of the system, and prints information about it.
@@ -114,6 +131,17 @@ QStorageInfo::QStorageInfo(const QStorageInfo &other)
 {
 }
 
+/*!
+    \internal
+
+    Constructs a QStorageInfo object that takes ownership of the already
+    filled \a dd private.
+*/
+QStorageInfo::QStorageInfo(QStorageInfoPrivate &dd)
+    : d(&dd)
+{
+}
+
 /*!
     Destroys the QStorageInfo object and frees its resources.
 */
@@ -153,11 +181,17 @@ QStorageInfo &QStorageInfo::operator=(const QStorageInfo &other)
 */
 void QStorageInfo::setPath(const QString &path)
 {
-    if (d->rootPath == path)
+    if (rootPath() == path)
         return;
-    d.detach();
-    d->rootPath = path;
-    d->doStat();
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    d = QStorageInfoPrivate::volumeForPath(path);
+#else
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> dd(new QStorageInfoPrivate);
+    dd->rootPath = path;
+    dd->doStat();
+    d = dd;
+#endif
 }
 
 /*!
@@ -176,6 +210,7 @@ void QStorageInfo::setPath(const QString &path)
 */
 QString QStorageInfo::rootPath() const
 {
+    QMutexLocker locker(&d->mutex);
     return d->rootPath;
 }
 
@@ -192,6 +227,8 @@ QString QStorageInfo::rootPath() const
 */
 qint64 QStorageInfo::bytesAvailable() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
     return d->bytesAvailable;
 }
 
@@ -206,6 +243,8 @@ qint64 QStorageInfo::bytesAvailable() const
 */
 qint64 QStorageInfo::bytesFree() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
     return d->bytesFree;
 }
 
@@ -218,9 +257,260 @@ qint64 QStorageInfo::bytesFree() const
 */
 qint64 QStorageInfo::bytesTotal() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
     return d->bytesTotal;
 }
 
+/*!
+    Returns the number of file nodes (inodes) of the volume, or -1 if it is
+    unknown. Filesystems that allocate inodes dynamically may report 0.
+
+    This and the other values that statvfs() reports are retrieved together
+    with the space information, so they cost no additional system call.
+
+    \sa filesFree(), filesAvailable(), bytesTotal()
+*/
+qint64 QStorageInfo::filesTotal() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->filesTotal;
+}
+
+/*!
+    Returns the number of free file nodes of the volume, or -1 if it is
+    unknown.
+
+    \sa filesTotal(), filesAvailable()
+*/
+qint64 QStorageInfo::filesFree() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->filesFree;
+}
+
+/*!
+    Returns the number of file nodes of the volume that are available to
+    the current user, or -1 if it is unknown. Like bytesAvailable(), this
+    can be less than filesFree() because of reserved nodes.
+
+    \sa filesTotal(), filesFree()
+*/
+qint64 QStorageInfo::filesAvailable() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->filesAvailable;
+}
+
+/*!
+    Returns the preferred block size of the filesystem in bytes, the
+    \c f_bsize of statvfs(), or -1 if it is unknown.
+
+    \sa fragmentSize()
+*/
+int QStorageInfo::blockSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->blockSize;
+}
+
+/*!
+    Returns the fundamental block size of the filesystem in bytes, the
+    \c f_frsize of statvfs(), or -1 if it is unknown. The space of the
+    volume is allocated in units of this size.
+
+    \sa blockSize()
+*/
+int QStorageInfo::fragmentSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->fragmentSize;
+}
+
+/*!
+    Returns the maximum length of a file name on the volume, or -1 if it is
+    unknown.
+*/
+int QStorageInfo::maximumFileNameLength() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->maximumFileNameLength;
+}
+
+/*!
+    \enum QStorageInfo::MountFlag
+
+    This enum describes the flags a volume is mounted with, as reported by
+    statvfs().
+
+    \value ReadOnlyMount       The volume is mounted read-only.
+    \value NoSuidMount         The set-user-ID and set-group-ID bits are ignored.
+    \value NoDevMount          Device files cannot be accessed.
+    \value NoExecMount         Programs cannot be executed.
+    \value SynchronousMount    Writes are synchronous.
+    \value MandatoryLockMount  Mandatory locks are allowed.
+    \value NoAtimeMount        Access times are not updated.
+    \value NoDirAtimeMount     Access times of directories are not updated.
+    \value RelAtimeMount       Access times are only updated relative to the
+                               modification time.
+*/
+
+/*!
+    Returns the flags the volume is mounted with. Which flags are reported
+    depends on the platform; on Windows only ReadOnlyMount is.
+
+    \sa isReadOnly()
+*/
+QStorageInfo::MountFlags QStorageInfo::mountFlags() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return MountFlags(d->mountFlags);
+}
+
+// The I/O geometry needs the volume information: a volume that did not
+// answer statvfs() in time is not asked again.
+static const uint ioGeometryFields = QStorageInfoPrivate::VolumeInfoField
+        | QStorageInfoPrivate::IoGeometryField;
+
+/*!
+    Returns the block size in bytes that the filesystem prefers for I/O on
+    the root path of the volume, the \c st_blksize of stat(), or -1 if it
+    is unknown. Reading and writing in multiples of this size avoids
+    inefficient read-modify-write cycles.
+
+    The I/O geometry is retrieved on the first access to any of its values
+    and, unlike the space information, not updated by refreshSpace(). It is
+    only available on Unix systems; the limits of the block device are only
+    available on Linux.
+
+    \sa blockSize(), logicalBlockSize(), optimalIoSize()
+*/
+int QStorageInfo::ioBlockSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->ioBlockSize;
+}
+
+/*!
+    Returns the logical block size of the device the volume is on in bytes,
+    or -1 if it is unknown. This is the smallest unit the device can
+    address; buffers and file offsets used for unbuffered I/O
+    (\c O_DIRECT) must be aligned to it.
+
+    \sa physicalBlockSize(), ioBlockSize()
+*/
+int QStorageInfo::logicalBlockSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->logicalBlockSize;
+}
+
+/*!
+    Returns the physical block size of the device the volume is on in bytes,
+    or -1 if it is unknown. Writes smaller than this size make the device
+    read and rewrite the whole block.
+
+    \sa logicalBlockSize(), minimumIoSize()
+*/
+int QStorageInfo::physicalBlockSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->physicalBlockSize;
+}
+
+/*!
+    Returns the smallest I/O size in bytes the device the volume is on
+    prefers, or -1 if it is unknown. For RAID devices this is the chunk
+    size.
+
+    \sa optimalIoSize(), physicalBlockSize()
+*/
+int QStorageInfo::minimumIoSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->minimumIoSize;
+}
+
+/*!
+    Returns the I/O size in bytes the device the volume is on prefers for
+    sustained transfers, or -1 if it is unknown. Many devices do not report
+    it, in which case this is 0. For RAID devices this is the stripe width.
+
+    \sa minimumIoSize(), maximumTransferSize()
+*/
+int QStorageInfo::optimalIoSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->optimalIoSize;
+}
+
+/*!
+    Returns the largest transfer in bytes the kernel sends to the device the
+    volume is on in a single request, or -1 if it is unknown. Larger
+    requests are split.
+
+    \sa optimalIoSize()
+*/
+qint64 QStorageInfo::maximumTransferSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->maximumTransferSize;
+}
+
+/*!
+    Returns the granularity in bytes in which the device the volume is on
+    discards unused blocks, 0 if the device does not support discarding
+    (TRIM), or -1 if it is unknown.
+*/
+qint64 QStorageInfo::discardGranularity() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return d->discardGranularity;
+}
+
+/*!
+    \enum QStorageInfo::DeviceFlag
+
+    This enum describes properties of the block device a volume is on.
+
+    \value RotationalDevice        The device is a rotating disk, on which
+                                   random access is slow.
+    \value DaxDevice               The device supports direct access (DAX),
+                                   bypassing the page cache.
+    \value HostAwareZonedDevice    The device is zoned and prefers sequential
+                                   writes within each zone.
+    \value HostManagedZonedDevice  The device is zoned and only accepts
+                                   sequential writes within each zone.
+*/
+
+/*!
+    Returns the properties of the block device the volume is on. No flags
+    are set if they are unknown, for example for network filesystems or on
+    platforms other than Linux.
+
+    \sa optimalIoSize()
+*/
+QStorageInfo::DeviceFlags QStorageInfo::deviceFlags() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(ioGeometryFields, &locker);
+    return DeviceFlags(d->deviceFlags);
+}
+
 /*!
     Returns the type name of the filesystem.
 
@@ -232,9 +522,55 @@ qint64 QStorageInfo::bytesTotal() const
 */
 QByteArray QStorageInfo::fileSystemType() const
 {
+    QMutexLocker locker(&d->mutex);
     return d->fileSystemType;
 }
 
+/*!
+    \enum QStorageInfo::FileSystemTrait
+
+    This enum describes the properties of a type of filesystem.
+
+    \value PseudoFileSystem The filesystem holds no user data, like \c proc,
+           \c sysfs or \c tmpfs. mountedVolumes() skips these filesystems.
+    \value NetworkFileSystem The data is stored on another machine.
+    \value LocalBlockDevice The filesystem lives on a local block device.
+    \value SupportsLabels The filesystem can have a label, see name().
+    \value MayBlock Querying the filesystem can block for a long time, for
+           example because a server does not answer. See setQueryTimeout().
+*/
+
+/*!
+    Returns the traits of the filesystem of this volume.
+
+    The traits are taken from a built-in table of filesystem types, so they
+    are cheap to get and never query the volume. Filesystems of an unknown
+    type are classified by their device; on Linux, types the kernel marks as
+    \c nodev in \c /proc/filesystems are treated as pseudo filesystems.
+
+    \sa fileSystemType()
+*/
+QStorageInfo::FileSystemTraits QStorageInfo::fileSystemTraits() const
+{
+    QMutexLocker locker(&d->mutex);
+    if (d->fileSystemType.isEmpty())
+        return FileSystemTraits();
+    return FileSystemTraits(int(QStorageInfoPrivate::fileSystemTraits(d->fileSystemType, d->device)));
+}
+
+/*!
+    \overload
+
+    Returns the traits of filesystems of the given \a fileSystemType, as
+    reported by fileSystemType() or QStorageIterator::fileSystemType(). This
+    can be used to skip network or pseudo filesystems before creating
+    QStorageInfo objects for them.
+*/
+QStorageInfo::FileSystemTraits QStorageInfo::fileSystemTraits(const QByteArray &fileSystemType)
+{
+    return FileSystemTraits(int(QStorageInfoPrivate::fileSystemTraits(fileSystemType, QByteArray())));
+}
+
 /*!
     Returns the device for this volume.
 
@@ -246,6 +582,7 @@ QByteArray QStorageInfo::fileSystemType() const
 */
 QByteArray QStorageInfo::device() const
 {
+    QMutexLocker locker(&d->mutex);
     return d->device;
 }
 
@@ -263,14 +600,140 @@ QByteArray QStorageInfo::device() const
 */
 QString QStorageInfo::name() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::LabelField, &locker);
     return d->name;
 }
 
+/*!
+    Returns the UUID of the filesystem on this volume, the same value \c blkid
+    reports, or an empty byte array if it is not known.
+
+    On Linux, the UUID is taken from the \c /dev/disk/by-uuid links maintained
+    by \c udev. Other platforms currently always return an empty byte array.
+
+    \sa partitionUuid(), name(), device()
+*/
+QByteArray QStorageInfo::uuid() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::LabelField, &locker);
+    return d->uuid;
+}
+
+/*!
+    Returns the UUID of the partition this volume is on, as stored in the
+    partition table, or an empty byte array if it is not known. Unlike uuid(),
+    it does not change when the filesystem is recreated.
+
+    On Linux, the UUID is taken from the \c /dev/disk/by-partuuid links
+    maintained by \c udev. Other platforms currently always return an empty
+    byte array.
+
+    \sa uuid(), device()
+*/
+QByteArray QStorageInfo::partitionUuid() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::LabelField, &locker);
+    return d->partitionUuid;
+}
+
+/*!
+    Returns the kernel's unique ID of the mount this QStorageInfo object
+    represents, or -1 if it is not known.
+
+    Mount IDs may be reused after the filesystem is unmounted. This information
+    is only available on Linux.
+
+    \sa parentMountId()
+*/
+int QStorageInfo::mountId() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->mountId;
+}
+
+/*!
+    Returns the ID of the mount this mount is attached to, or -1 if it is not
+    known. The root of a mount namespace is its own parent.
+
+    This information is only available on Linux.
+
+    \sa mountId()
+*/
+int QStorageInfo::parentMountId() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->parentMountId;
+}
+
+/*!
+    Returns the major number of the device the filesystem lives on, or -1 if
+    it is not known. On most filesystems this is also the device \c stat
+    reports in \c st_dev for files on this volume.
+
+    This information is only available on Linux.
+
+    \sa minorDeviceNumber(), device()
+*/
+int QStorageInfo::majorDeviceNumber() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->deviceMajor;
+}
+
+/*!
+    Returns the minor number of the device the filesystem lives on, or -1 if it
+    is not known.
+
+    This information is only available on Linux.
+
+    \sa majorDeviceNumber(), device()
+*/
+int QStorageInfo::minorDeviceNumber() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->deviceMinor;
+}
+
+/*!
+    Returns the directory of the filesystem that is mounted at rootPath().
+
+    This is \c / unless only a part of the filesystem is mounted, which is the
+    case for bind mounts and btrfs subvolumes. An empty byte array is returned
+    if this information is not available; it is only available on Linux.
+
+    \sa rootPath()
+*/
+QByteArray QStorageInfo::fileSystemRoot() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->fileSystemRoot;
+}
+
+/*!
+    Returns the optional fields of the mount, such as \c shared:1 or
+    \c master:2, that describe how mount events propagate to and from this
+    mount.
+
+    This information is only available on Linux.
+*/
+QList<QByteArray> QStorageInfo::optionalFields() const
+{
+    QMutexLocker locker(&d->mutex);
+    if (d->optionalFields.isEmpty())
+        return QList<QByteArray>();
+    return d->optionalFields.split(' ');
+}
+
 /*!
     Returns the volume's name, if available, or the root path if not.
 */
 QString QStorageInfo::displayName() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::LabelField, &locker);
     if (!d->name.isEmpty())
         return d->name;
     return d->rootPath;
@@ -294,6 +757,8 @@ QString QStorageInfo::displayName() const
 */
 bool QStorageInfo::isReadOnly() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
     return d->readOnly;
 }
 
@@ -308,6 +773,8 @@ bool QStorageInfo::isReadOnly() const
 */
 bool QStorageInfo::isReady() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
     return d->ready;
 }
 
@@ -319,21 +786,102 @@ bool QStorageInfo::isReady() const
 */
 bool QStorageInfo::isValid() const
 {
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
     return d->valid;
 }
 
+/*!
+    Returns true if the filesystem did not answer within queryTimeout() the
+    last time its information was retrieved; false otherwise.
+
+    Such a volume is valid but not ready, and reports no space information.
+
+    \sa setQueryTimeout(), isReady()
+*/
+bool QStorageInfo::hasTimedOut() const
+{
+    QMutexLocker locker(&d->mutex);
+    d->fetch(QStorageInfoPrivate::VolumeInfoField, &locker);
+    return d->timedOut;
+}
+
 /*!
     Resets QStorageInfo's internal cache.
 
     QStorageInfo caches information about storage to speed up performance.
     QStorageInfo retrieves information during object construction and/or when calling
-    the setPath() method. You have to manually reset the cache by calling this
-    function to update storage information.
+    the setPath() method, or on Unix systems when it is first accessed. You have to manually reset the cache by calling this
+    function to update storage information. Use refreshSpace() if only the
+    space information needs to be updated.
+
+    On Unix systems, the cache is shared by all QStorageInfo objects that
+    refer to the same volume, copies included, and all of them see the updated
+    information. Constructing a QStorageInfo object or calling setPath() makes
+    the space information of the shared cache be retrieved again as well. On
+    other platforms only this object is updated; its copies keep the
+    information they had.
+
+    The mount table itself is shared by all QStorageInfo objects in the process.
+    On Linux it is only read again after the kernel reports that a filesystem
+    was mounted or unmounted.
 */
 void QStorageInfo::refresh()
 {
-    d.detach();
-    d->doStat();
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    // the (possibly slow) query runs without holding the lock
+    QStorageInfoPrivate fresh;
+    fresh.rootPath = rootPath();
+    fresh.doStat();
+
+    QMutexLocker locker(&d->mutex);
+    d->assign(fresh);
+#else
+    // without the volume registry, copies are independent
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> dd(new QStorageInfoPrivate);
+    dd->rootPath = rootPath();
+    dd->doStat();
+    d = dd;
+#endif
+}
+
+/*!
+    Updates bytesTotal(), bytesFree(), bytesAvailable(), isReadOnly() and
+    the other values reported by statvfs(), like filesFree() and
+    mountFlags(), but keeps everything else as it is.
+
+    Unlike refresh(), this does not look up the volume of rootPath() again and
+    does not retrieve the label. It is the cheap way of tracking the space of
+    a volume that is known to stay mounted. Which other objects see the
+    update is the same as for refresh().
+
+    \sa refresh()
+*/
+void QStorageInfo::refreshSpace()
+{
+    QStorageInfoPrivate fresh;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (d->rootPath.isEmpty())
+            return;
+        fresh.assign(*d);
+    }
+    fresh.doStatSpace();
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    // Only the space is applied: a refresh() or a fetch of other fields may
+    // have completed meanwhile, or moved the object to another volume.
+    QMutexLocker locker(&d->mutex);
+    if (fresh.rootPath != d->rootPath || fresh.device != d->device)
+        return;
+    d->assignVolumeInfo(fresh);
+    d->fetched |= QStorageInfoPrivate::VolumeInfoField;
+#else
+    // without the volume registry, copies are independent
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> dd(new QStorageInfoPrivate);
+    dd->assign(fresh);
+    d = dd;
+#endif
 }
 
 /*!
@@ -350,13 +898,286 @@ void QStorageInfo::refresh()
 
     \snippet code/src_corelib_io_qstorageinfo.cpp 1
 
-    \sa root()
+    \sa root(), mountedVolumesAsync()
 */
 QList<QStorageInfo> QStorageInfo::mountedVolumes()
 {
     return QStorageInfoPrivate::mountedVolumes();
 }
 
+namespace {
+
+struct QStorageVolumesJob
+{
+    QFutureInterface<QStorageInfo> future;
+    QAtomicInt remaining;
+};
+
+class QStorageVolumesTask : public QRunnable
+{
+public:
+    inline explicit QStorageVolumesTask(const QSharedPointer<QStorageVolumesJob> &job)
+        : job(job)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        if (!job->future.isCanceled())
+            retrieve();
+        if (!job->remaining.deref())
+            job->future.reportFinished();
+    }
+
+protected:
+    virtual void retrieve()
+    {
+        const QList<QStorageInfo> volumes = QStorageInfoPrivate::mountedVolumes();
+        for (int i = 0; i < volumes.size(); ++i)
+            job->future.reportResult(volumes.at(i), i);
+    }
+
+    QSharedPointer<QStorageVolumesJob> job;
+};
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+class QStorageVolumeStatTask : public QStorageVolumesTask
+{
+public:
+    inline QStorageVolumeStatTask(const QSharedPointer<QStorageVolumesJob> &job,
+                                  const QStorageMountEntry &entry, int index)
+        : QStorageVolumesTask(job), entry(entry), index(index)
+    {}
+
+protected:
+    void retrieve() Q_DECL_OVERRIDE
+    {
+        job->future.reportResult(QStorageInfoPrivate::fromMountEntry(entry), index);
+    }
+
+private:
+    QStorageMountEntry entry;
+    int index;
+};
+#endif
+
+} // namespace
+
+/*!
+    Returns a future that receives the QStorageInfo objects for the currently
+    mounted filesystems, in the same order as mountedVolumes() returns them.
+
+    The volumes are queried on the threads of \a pool, or of
+    QThreadPool::globalInstance() if \a pool is null, and the calling thread is
+    never blocked. On Unix systems every volume is queried by its own task, so
+    each result is reported as soon as its volume answers and a slow network
+    filesystem does not hold back the others. Use QFutureWatcher::resultReadyAt()
+    to receive the volumes one by one, or QFuture::results() to get the
+    complete list once the future has finished.
+
+    Note that a hanging filesystem occupies one thread of \a pool until it
+    responds; pass a dedicated pool if that matters.
+
+    \sa mountedVolumes()
+*/
+QFuture<QStorageInfo> QStorageInfo::mountedVolumesAsync(QThreadPool *pool)
+{
+    if (!pool)
+        pool = QThreadPool::globalInstance();
+
+    QSharedPointer<QStorageVolumesJob> job(new QStorageVolumesJob);
+    job->future.reportStarted();
+    QFuture<QStorageInfo> future = job->future.future();
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    const QStorageMountTable table = QStorageInfoPrivate::mountTable();
+    if (table.valid) {
+        QList<QRunnable *> tasks;
+        for (int i = 0; i < table.entries.size(); ++i) {
+            const QStorageMountEntry &entry = table.entries.at(i);
+            if (!entry.pseudo)
+                tasks.append(new QStorageVolumeStatTask(job, entry, tasks.size()));
+        }
+
+        if (tasks.isEmpty()) {
+            job->future.reportFinished();
+            return future;
+        }
+
+        job->remaining.store(tasks.size());
+        foreach (QRunnable *task, tasks)
+            pool->start(task);
+        return future;
+    }
+#endif
+
+    job->remaining.store(1);
+    pool->start(new QStorageVolumesTask(job));
+    return future;
+}
+
+/*!
+    \enum QStorageInfo::MountedVolumesFlag
+
+    This enum controls which volumes forEachMountedVolume() enumerates and
+    how much it queries about them.
+
+    \value NoFlags The same volumes as mountedVolumes() returns, fully queried.
+    \value IncludePseudoFileSystems Also pass pseudo filesystems like \c proc,
+           \c sysfs or \c tmpfs to the callback. This has no effect on Windows.
+    \value SkipVolumeInfo Do not query the volumes before passing them to the
+           callback; only the data known from the mount table, like rootPath(),
+           device() and fileSystemType(), is retrieved. On Unix systems the rest
+           is retrieved when it is first accessed, unless it is already cached.
+*/
+
+/*!
+    \typedef QStorageInfo::VolumeCallback
+
+    Type of the plain function forEachMountedVolume() can call for each
+    volume. It is passed the volume and the context pointer given to
+    forEachMountedVolume(), and returns false to stop the enumeration.
+*/
+
+/*!
+    \fn template <typename Callback> void QStorageInfo::forEachMountedVolume(Callback callback, MountedVolumesFlags flags)
+
+    Calls \a callback for each mounted filesystem, in the same order as
+    mountedVolumes() returns them, while the filesystems are being
+    enumerated. \a callback can be a lambda, a function object or a function
+    pointer that takes a \c{const QStorageInfo &} and returns a bool. If it
+    returns false, the enumeration stops and the remaining volumes are not
+    queried at all.
+
+    Unlike mountedVolumes(), this does not build a list of all volumes first.
+    On Unix systems each volume is only queried right before it is passed to
+    \a callback, so finding the first volume that matches some condition
+    does not cost a query of every mounted filesystem. On other platforms
+    the volumes are still collected up front.
+
+    The example shows how to find the first volume with at least 50 GB of
+    free space:
+
+    \code
+    QStorageInfo found;
+    QStorageInfo::forEachMountedVolume([&found](const QStorageInfo &storage) {
+        if (storage.bytesAvailable() < 50LL * 1024 * 1024 * 1024)
+            return true;
+        found = storage;
+        return false;
+    });
+    \endcode
+
+    \a flags selects which volumes are enumerated and whether they are
+    queried.
+
+    \sa mountedVolumes()
+*/
+
+/*!
+    \overload
+
+    Calls \a callback with each mounted filesystem and \a context, for
+    example a pointer to the object the results are collected in. This is
+    what the template overload uses; it is also available to code that cannot
+    pass a lambda.
+
+    \a flags selects which volumes are enumerated and whether they are
+    queried.
+*/
+void QStorageInfo::forEachMountedVolume(VolumeCallback callback, void *context,
+                                        MountedVolumesFlags flags)
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    const QStorageMountTable table = QStorageInfoPrivate::mountTable();
+    if (table.valid) {
+        const bool retrieveInfo = !(flags & SkipVolumeInfo);
+        for (int i = 0; i < table.entries.size(); ++i) {
+            const QStorageMountEntry &entry = table.entries.at(i);
+            if (entry.pseudo && !(flags & IncludePseudoFileSystems))
+                continue;
+            if (!callback(QStorageInfoPrivate::fromMountEntry(entry, retrieveInfo), context))
+                return;
+        }
+        return;
+    }
+#else
+    Q_UNUSED(flags);
+#endif
+
+    foreach (const QStorageInfo &info, QStorageInfoPrivate::mountedVolumes()) {
+        if (!callback(info, context))
+            return;
+    }
+}
+
+/*!
+    Returns the volumes the given \a paths are located on, as a hash from each
+    path to its volume.
+
+    This gives the same results as constructing a QStorageInfo object for
+    every path, but is much faster for large batches: only the mount point is
+    looked up for every path, each volume is queried only once, and all paths
+    on the same volume share one QStorageInfo object. On Unix systems, all
+    paths are resolved against one snapshot of the mount table. Paths that do
+    not exist are mapped to an invalid QStorageInfo.
+
+    \sa QStorageInfo(const QString &), mountedVolumes()
+*/
+QHash<QString, QStorageInfo> QStorageInfo::forPaths(const QStringList &paths)
+{
+    QHash<QString, QStorageInfo> result;
+    result.reserve(paths.size());
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    const QStorageMountTable table = QStorageInfoPrivate::mountTable();
+    if (table.valid) {
+        const QStorageInfo invalid;
+        QHash<int, QStorageInfo> volumes;
+
+        foreach (const QString &path, paths) {
+            if (result.contains(path))
+                continue;
+
+            QStoragePhaseTimer timer(QStorageStatistics::CanonicalPathPhase);
+            const QString canonicalPath = QFileInfo(path).canonicalFilePath();
+            timer.stop();
+            const int index = canonicalPath.isEmpty() ? -1 : table.findVolume(canonicalPath);
+            if (index == -1) {
+                result.insert(path, invalid);
+                continue;
+            }
+
+            QHash<int, QStorageInfo>::iterator it = volumes.find(index);
+            if (it == volumes.end())
+                it = volumes.insert(index, QStorageInfoPrivate::fromMountEntry(table.entries.at(index)));
+            result.insert(path, it.value());
+        }
+        return result;
+    }
+#endif
+
+    QHash<QString, QStorageInfo> volumes;
+    foreach (const QString &path, paths) {
+        if (result.contains(path))
+            continue;
+
+        // only the root path is resolved for every path; each volume is
+        // queried once, when the first path on it is seen
+        QStorageInfoPrivate lookup;
+        lookup.rootPath = path;
+        lookup.initRootPath();
+
+        QHash<QString, QStorageInfo>::iterator it = volumes.find(lookup.rootPath);
+        if (it == volumes.end()) {
+            it = volumes.insert(lookup.rootPath, lookup.rootPath.isEmpty()
+                                                 ? QStorageInfo()
+                                                 : QStorageInfo(lookup.rootPath));
+        }
+        result.insert(path, it.value());
+    }
+    return result;
+}
+
 Q_GLOBAL_STATIC_WITH_ARGS(QStorageInfo, getRoot, (QStorageInfoPrivate::root()))
 
 /*!
@@ -372,6 +1193,451 @@ QStorageInfo QStorageInfo::root()
     return *getRoot();
 }
 
+namespace {
+struct QStorageFileSystemType
+{
+    const char *name;
+    uint traits;
+};
+} // namespace
+
+// Traits of the filesystem types we know about, sorted by name. Mind that
+// fileSystemTypeSlots has to be updated when entries are added or removed.
+static Q_DECL_CONSTEXPR const QStorageFileSystemType fileSystemTypes[] = {
+    { "9p", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "afpfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "afs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "apfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "aufs", 0 },
+    { "autofs", QStorageInfo::PseudoFileSystem | QStorageInfo::MayBlock },
+    { "bcachefs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "beegfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "binfmt_misc", QStorageInfo::PseudoFileSystem },
+    { "bpf", QStorageInfo::PseudoFileSystem },
+    { "btrfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "cd9660", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "cdfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ceph", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "cgroup", QStorageInfo::PseudoFileSystem },
+    { "cgroup2", QStorageInfo::PseudoFileSystem },
+    { "cifs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "coda", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "configfs", QStorageInfo::PseudoFileSystem },
+    { "cpuset", QStorageInfo::PseudoFileSystem },
+    { "ctfs", QStorageInfo::PseudoFileSystem },
+    { "davfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "debugfs", QStorageInfo::PseudoFileSystem },
+    { "devfs", QStorageInfo::PseudoFileSystem },
+    { "devpts", QStorageInfo::PseudoFileSystem },
+    { "devtmpfs", QStorageInfo::PseudoFileSystem },
+    { "efivarfs", QStorageInfo::PseudoFileSystem },
+    { "erofs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "exfat", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ext2", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ext2fs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ext3", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ext4", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "f2fs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "fat32", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "fdescfs", QStorageInfo::PseudoFileSystem },
+    { "ffs", QStorageInfo::LocalBlockDevice },
+    { "fuse", QStorageInfo::MayBlock },
+    { "fuseblk", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "fusectl", QStorageInfo::PseudoFileSystem },
+    { "gfs2", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "glusterfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "gpfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "hammer", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "hammer2", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "hfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "hfsplus", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "hugetlbfs", QStorageInfo::PseudoFileSystem },
+    { "iso9660", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "jfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "kernfs", QStorageInfo::PseudoFileSystem },
+    { "linprocfs", QStorageInfo::PseudoFileSystem },
+    { "linsysfs", QStorageInfo::PseudoFileSystem },
+    { "lofs", 0 },
+    { "lustre", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "lxcfs", QStorageInfo::PseudoFileSystem },
+    { "minix", QStorageInfo::LocalBlockDevice },
+    { "mntfs", QStorageInfo::PseudoFileSystem },
+    { "mqueue", QStorageInfo::PseudoFileSystem },
+    { "msdos", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "msdosfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ncpfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "nfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "nfs4", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "nfsd", QStorageInfo::PseudoFileSystem },
+    { "nilfs2", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "nsfs", QStorageInfo::PseudoFileSystem },
+    { "ntfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ntfs3", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "nullfs", 0 },
+    { "objfs", QStorageInfo::PseudoFileSystem },
+    { "ocfs2", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "overlay", 0 },
+    { "pipefs", QStorageInfo::PseudoFileSystem },
+    { "portal", QStorageInfo::PseudoFileSystem },
+    { "proc", QStorageInfo::PseudoFileSystem },
+    { "procfs", QStorageInfo::PseudoFileSystem },
+    { "pstore", QStorageInfo::PseudoFileSystem },
+    { "ptyfs", QStorageInfo::PseudoFileSystem },
+    { "ramfs", QStorageInfo::PseudoFileSystem },
+    { "refs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "reiserfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "rootfs", QStorageInfo::PseudoFileSystem },
+    { "rpc_pipefs", QStorageInfo::PseudoFileSystem },
+    { "s3fs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "securityfs", QStorageInfo::PseudoFileSystem },
+    { "selinuxfs", QStorageInfo::PseudoFileSystem },
+    { "sharefs", QStorageInfo::PseudoFileSystem },
+    { "smb3", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "smbfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "sockfs", QStorageInfo::PseudoFileSystem },
+    { "squashfs", QStorageInfo::LocalBlockDevice },
+    { "sshfs", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "sysfs", QStorageInfo::PseudoFileSystem },
+    { "tmpfs", QStorageInfo::PseudoFileSystem },
+    { "tracefs", QStorageInfo::PseudoFileSystem },
+    { "udf", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "ufs", QStorageInfo::LocalBlockDevice },
+    { "unionfs", 0 },
+    { "vfat", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "webdav", QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock },
+    { "xfs", QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels },
+    { "zfs", QStorageInfo::SupportsLabels },
+};
+
+static const int fileSystemTypeCount = int(sizeof(fileSystemTypes) / sizeof(fileSystemTypes[0]));
+
+// FNV-1a with an offset basis that gives every name above its own slot
+static const uint fileSystemTypeSeed = 0x811cc890u;
+
+static Q_DECL_CONSTEXPR inline uint fileSystemTypeHash(const char *name, uint hash)
+{
+    return *name ? fileSystemTypeHash(name + 1, (hash ^ uchar(*name)) * 16777619u) : hash;
+}
+
+static Q_DECL_CONSTEXPR inline uint fileSystemTypeSlot(const char *name)
+{
+    return fileSystemTypeHash(name, fileSystemTypeSeed) >> 23;
+}
+
+// The index + 1 of the name in fileSystemTypes that hashes to each slot, or 0
+static Q_DECL_CONSTEXPR const uchar fileSystemTypeSlots[512] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,  24,  91,   0,   0,   0,   0,  79,
+      0,   0,   0,   0,   0,   0,   0,  81,   0,   0,   0,   0,   0,  27,   0,   0,
+      0,   0,   0,   0,   0,   0,  51,   0,   0,   0,  44,   5,   0,   0,   0,   0,
+      8,  93,   0,   0,  10,   0,   0,   0,   0,   0,  90,   0,   0,   0,   0,   0,
+      0,   0,   0,  36,   0,   0,   0,   0,   0,   0,   0,   0,  16,   0,   0,  55,
+      0,   0,   0,   0,   0,  63,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0, 101,   0,  64,   0,   0,  11,  95,  26,   0,   0,  17,   0,   0,   0,   0,
+      0,  59,   0,   0,   0,   0,   0,   0,   0,   6,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  82,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  40,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,  42,   0,   0,   0,   0,   0,   0,   0,   0,   0,  73,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  54,   0,   0,  60,   0,
+      0,   0,   0,  65,   0,  19,   0,  67,   0,   0,   0,   0,  86,   0,   0,   0,
+     69,  70,   0,   0,  32,  47,  30,   0,   0,   0,   0,   0,  14,  28,   0,   0,
+      0,   0,  33,   0,   0,   0,   0,   0,   0,  97,  62,   0,  22,   0, 100,   0,
+      0,   0,  99,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  35,
+     50,   0,   0,   0,  68,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  21,   0,   0,   0,   0,   0,   0,   0,   0,  98,
+      0,  80,   0,   0,   0,   0,  83,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,  20,   0,   0,   0,   0,  78,   0,   0,   0,   0,   0,   0,   0,  52,
+      0,  92,   0,  94,   0,  89,   0,   0,   0,  46,  74,  96,  72,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  61,   0,   0,  25,   0,  87,  23,   0,   0,   0,
+      0, 103,   0,   0,   0,   3,   0,   0,   0,   0,   0,  18,   0,   0,   0,  48,
+      0,   0,   0,  66,   0,   0,  56,   0,   0,   0,   0,   0,  13,  71,   0,   0,
+      0,  43,   0,   0,   0,   0,   0,   1,   0,   0,   0,   0,   9,   0,  45,  76,
+     49,   0,   7,   0,  29,  38,   0,  75,   0,   0,   0,   4,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,  37,   0,  39,   0,   0,   0,  88,   0, 102,
+      0,   0,   0,  15,  77,   0,  85,  84,   0,   0,   0,   0,   0,   0,  31,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     12,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,  34,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      2,   0,  57,   0,   0,   0,   0,   0,  41,   0,  53,   0,   0,   0,  58,   0,
+};
+
+#ifdef Q_COMPILER_CONSTEXPR
+static Q_DECL_CONSTEXPR bool isPerfectHash(int index)
+{
+    return index == fileSystemTypeCount
+            || (fileSystemTypeSlots[fileSystemTypeSlot(fileSystemTypes[index].name)] == index + 1
+                && isPerfectHash(index + 1));
+}
+
+Q_STATIC_ASSERT_X(isPerfectHash(0), "fileSystemTypeSlots does not match fileSystemTypes");
+#endif
+
+// Returns the entry for \a type, compared case insensitively, or null.
+static const QStorageFileSystemType *findFileSystemType(const char *type, int size)
+{
+    char name[16];
+    if (size <= 0 || size >= int(sizeof(name)))
+        return Q_NULLPTR;
+    for (int i = 0; i < size; ++i)
+        name[i] = (type[i] >= 'A' && type[i] <= 'Z') ? char(type[i] - 'A' + 'a') : type[i];
+    name[size] = '\0';
+
+    const int index = fileSystemTypeSlots[fileSystemTypeSlot(name)];
+    if (index == 0 || qstrcmp(fileSystemTypes[index - 1].name, name) != 0)
+        return Q_NULLPTR;
+    return &fileSystemTypes[index - 1];
+}
+
+#if defined(Q_OS_LINUX)
+// The filesystem types the kernel marks as "nodev" in /proc/filesystems,
+// i.e. the ones that are not backed by a block device.
+class QStorageNodevFileSystems
+{
+public:
+    QStorageNodevFileSystems()
+    {
+        QFile file(QStringLiteral("/proc/filesystems"));
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+        foreach (const QByteArray &line, file.readAll().split('\n')) {
+            if (line.startsWith("nodev"))
+                types.insert(line.mid(5).trimmed());
+        }
+    }
+
+    QSet<QByteArray> types;
+};
+
+Q_GLOBAL_STATIC(QStorageNodevFileSystems, nodevFileSystems)
+#endif
+
+static bool isNetworkDevice(const QByteArray &device)
+{
+    // host:/path (NFS), //server/share (CIFS) and \\server\share (Windows)
+    if (device.startsWith("//"))
+        return true;
+    if (device.startsWith("\\\\"))
+        return !device.startsWith("\\\\?\\");
+    const int colon = device.indexOf(':');
+    return colon > 0 && device.indexOf('/') == colon + 1;
+}
+
+uint QStorageInfoPrivate::fileSystemTraits(const QByteArray &type, const QByteArray &device)
+{
+    if (const QStorageFileSystemType *known = findFileSystemType(type.constData(), type.size()))
+        return known->traits;
+
+    // FUSE filesystems are reported as "fuse.<name>" and may hang like
+    // any other userspace server
+    if (type.startsWith("fuse.")) {
+        const QStorageFileSystemType *known = findFileSystemType(type.constData() + 5, type.size() - 5);
+        return (known ? known->traits : 0) | QStorageInfo::MayBlock;
+    }
+
+    if (isNetworkDevice(device))
+        return QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock;
+
+#if defined(Q_OS_LINUX)
+    // a type we don't know: ask the kernel whether it needs a device
+    if (QStorageNodevFileSystems *nodev = nodevFileSystems()) {
+        if (nodev->types.contains(type))
+            return QStorageInfo::PseudoFileSystem;
+    }
+#endif
+    if (device.startsWith("/dev/"))
+        return QStorageInfo::LocalBlockDevice;
+    return 0;
+}
+
+QStorageInfoPrivate::~QStorageInfoPrivate()
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    if (!registryKey.isEmpty())
+        unregisterVolume();
+#endif
+}
+
+void QStorageInfoPrivate::assign(const QStorageInfoPrivate &other)
+{
+    rootPath = other.rootPath;
+    device = other.device;
+    fileSystemType = other.fileSystemType;
+    name = other.name;
+    uuid = other.uuid;
+    partitionUuid = other.partitionUuid;
+    fileSystemRoot = other.fileSystemRoot;
+    optionalFields = other.optionalFields;
+
+    mountId = other.mountId;
+    parentMountId = other.parentMountId;
+    deviceMajor = other.deviceMajor;
+    deviceMinor = other.deviceMinor;
+
+    assignVolumeInfo(other);
+    assignIoGeometry(other);
+
+    fetched = other.fetched;
+}
+
+// Copies what VolumeInfoField stands for.
+void QStorageInfoPrivate::assignVolumeInfo(const QStorageInfoPrivate &other)
+{
+    bytesTotal = other.bytesTotal;
+    bytesFree = other.bytesFree;
+    bytesAvailable = other.bytesAvailable;
+
+    filesTotal = other.filesTotal;
+    filesFree = other.filesFree;
+    filesAvailable = other.filesAvailable;
+    blockSize = other.blockSize;
+    fragmentSize = other.fragmentSize;
+    maximumFileNameLength = other.maximumFileNameLength;
+    mountFlags = other.mountFlags;
+
+    readOnly = other.readOnly;
+    ready = other.ready;
+    valid = other.valid;
+    timedOut = other.timedOut;
+}
+
+// Copies what IoGeometryField stands for.
+void QStorageInfoPrivate::assignIoGeometry(const QStorageInfoPrivate &other)
+{
+    ioBlockSize = other.ioBlockSize;
+    logicalBlockSize = other.logicalBlockSize;
+    physicalBlockSize = other.physicalBlockSize;
+    minimumIoSize = other.minimumIoSize;
+    optimalIoSize = other.optimalIoSize;
+    maximumTransferSize = other.maximumTransferSize;
+    discardGranularity = other.discardGranularity;
+    deviceFlags = other.deviceFlags;
+}
+
+void QStorageInfoPrivate::fetch(uint fields, QMutexLocker *locker)
+{
+    fields &= ~fetched;
+    if (!fields)
+        return;
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    if (!rootPath.isEmpty()) {
+        // the (possibly slow) query runs without holding the lock
+        QStorageInfoPrivate fresh;
+        fresh.rootPath = rootPath;
+        fresh.device = device;
+        fresh.deviceMajor = deviceMajor;
+        fresh.deviceMinor = deviceMinor;
+        fresh.timedOut = timedOut;
+        locker->unlock();
+        if (fields & VolumeInfoField)
+            fresh.retrieveVolumeInfo();
+        if (fields & LabelField)
+            fresh.retrieveLabel();
+        if (fields & IoGeometryField)
+            fresh.retrieveIoGeometry();
+        locker->relock();
+
+        // a refresh may have moved the object to another volume meanwhile
+        if (fresh.rootPath != rootPath || fresh.device != device)
+            return;
+
+        if (fields & VolumeInfoField)
+            assignVolumeInfo(fresh);
+        if (fields & LabelField) {
+            name = fresh.name;
+            uuid = fresh.uuid;
+            partitionUuid = fresh.partitionUuid;
+        }
+        if (fields & IoGeometryField)
+            assignIoGeometry(fresh);
+    }
+#else
+    // everything is retrieved up front on the other platforms
+    Q_UNUSED(locker);
+#endif
+    fetched |= fields;
+}
+
+QBasicAtomicInt QStorageInfoPrivate::queryTimeout = Q_BASIC_ATOMIC_INITIALIZER(-1);
+
+/*!
+    Returns the time in milliseconds QStorageInfo waits for a filesystem to
+    report its state, or -1 if it waits forever, which is the default.
+
+    \sa setQueryTimeout()
+*/
+int QStorageInfo::queryTimeout()
+{
+    return QStorageInfoPrivate::queryTimeout.load();
+}
+
+/*!
+    Sets the time QStorageInfo waits for a filesystem to report its state to
+    \a msecs milliseconds. A negative value disables the timeout.
+
+    Querying a network filesystem whose server is unreachable can block the
+    calling thread indefinitely. With a timeout set, each query is made by a
+    worker thread, and a filesystem that does not answer in time is reported
+    as not ready, with hasTimedOut() returning true. A worker stuck on such a
+    filesystem is reused once the system call returns, and repeated queries
+    for that filesystem wait for the pending one instead of occupying more
+    threads.
+
+    The timeout applies to all QStorageInfo objects in the process. It is
+    currently only supported on Unix systems.
+
+    \sa queryTimeout(), hasTimedOut(), refresh()
+*/
+void QStorageInfo::setQueryTimeout(int msecs)
+{
+    QStorageInfoPrivate::queryTimeout.store(msecs < 0 ? -1 : msecs);
+}
+
+/*!
+    Returns a copy of the statistics QStorageInfo collected in this process
+    since they were enabled or last reset.
+
+    \sa setStatisticsEnabled(), resetStatistics()
+*/
+QStorageStatistics QStorageInfo::statistics()
+{
+    return QStorageStatisticsCollector::snapshot();
+}
+
+/*!
+    Returns true if QStorageInfo collects statistics; otherwise returns
+    false, which is the default.
+
+    \sa setStatisticsEnabled()
+*/
+bool QStorageInfo::isStatisticsEnabled()
+{
+    return QStorageStatisticsCollector::isEnabled();
+}
+
+/*!
+    Enables the collection of statistics if \a enable is true, or disables
+    it. Disabling the collection keeps the statistics gathered so far.
+
+    Collecting statistics costs a few atomic operations and a clock reading
+    per phase of each query, and is meant for profiling and monitoring.
+
+    \sa statistics(), resetStatistics()
+*/
+void QStorageInfo::setStatisticsEnabled(bool enable)
+{
+    QStorageStatisticsCollector::setEnabled(enable);
+}
+
+/*!
+    Sets all counters and histograms of the statistics back to zero.
+
+    \sa statistics()
+*/
+void QStorageInfo::resetStatistics()
+{
+    QStorageStatisticsCollector::reset();
+}
+
 /*!
     \fn inline bool operator==(const QStorageInfo &first, const QStorageInfo &second)
 
@@ -36,17 +36,62 @@
 
 #include <QtCore/qbytearray.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qflags.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmetatype.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
 #include <QtCore/qshareddata.h>
 
+#include "qstoragestatistics.h"
+
 QT_BEGIN_NAMESPACE
 
+class QThreadPool;
+
 class QStorageInfoPrivate;
 class QSTORAGEINFO_EXPORT QStorageInfo
 {
 public:
+    enum MountedVolumesFlag {
+        NoFlags = 0x0,
+        IncludePseudoFileSystems = 0x1,
+        SkipVolumeInfo = 0x2
+    };
+    Q_DECLARE_FLAGS(MountedVolumesFlags, MountedVolumesFlag)
+
+    enum FileSystemTrait {
+        PseudoFileSystem = 0x01,
+        NetworkFileSystem = 0x02,
+        LocalBlockDevice = 0x04,
+        SupportsLabels = 0x08,
+        MayBlock = 0x10
+    };
+    Q_DECLARE_FLAGS(FileSystemTraits, FileSystemTrait)
+
+    enum MountFlag {
+        ReadOnlyMount = 0x001,
+        NoSuidMount = 0x002,
+        NoDevMount = 0x004,
+        NoExecMount = 0x008,
+        SynchronousMount = 0x010,
+        MandatoryLockMount = 0x020,
+        NoAtimeMount = 0x040,
+        NoDirAtimeMount = 0x080,
+        RelAtimeMount = 0x100
+    };
+    Q_DECLARE_FLAGS(MountFlags, MountFlag)
+
+    enum DeviceFlag {
+        RotationalDevice = 0x01,
+        DaxDevice = 0x02,
+        HostAwareZonedDevice = 0x04,
+        HostManagedZonedDevice = 0x08
+    };
+    Q_DECLARE_FLAGS(DeviceFlags, DeviceFlag)
+
     QStorageInfo();
     explicit QStorageInfo(const QString &path);
     explicit QStorageInfo(const QDir &dir);
@@ -67,29 +112,92 @@ public:
     QString rootPath() const;
     QByteArray device() const;
     QByteArray fileSystemType() const;
+    FileSystemTraits fileSystemTraits() const;
     QString name() const;
     QString displayName() const;
+    QByteArray uuid() const;
+    QByteArray partitionUuid() const;
+
+    int mountId() const;
+    int parentMountId() const;
+    int majorDeviceNumber() const;
+    int minorDeviceNumber() const;
+    QByteArray fileSystemRoot() const;
+    QList<QByteArray> optionalFields() const;
 
     qint64 bytesTotal() const;
     qint64 bytesFree() const;
     qint64 bytesAvailable() const;
 
+    qint64 filesTotal() const;
+    qint64 filesFree() const;
+    qint64 filesAvailable() const;
+
+    int blockSize() const;
+    int fragmentSize() const;
+    int maximumFileNameLength() const;
+    MountFlags mountFlags() const;
+
+    int ioBlockSize() const;
+    int logicalBlockSize() const;
+    int physicalBlockSize() const;
+    int minimumIoSize() const;
+    int optimalIoSize() const;
+    qint64 maximumTransferSize() const;
+    qint64 discardGranularity() const;
+    DeviceFlags deviceFlags() const;
+
     inline bool isRoot() const;
     bool isReadOnly() const;
     bool isReady() const;
     bool isValid() const;
+    bool hasTimedOut() const;
 
     void refresh();
+    void refreshSpace();
 
     static QList<QStorageInfo> mountedVolumes();
+    static QFuture<QStorageInfo> mountedVolumesAsync(QThreadPool *pool = Q_NULLPTR);
+    typedef bool (*VolumeCallback)(const QStorageInfo &volume, void *context);
+    static void forEachMountedVolume(VolumeCallback callback, void *context,
+                                     MountedVolumesFlags flags = NoFlags);
+    template <typename Callback>
+    static inline void forEachMountedVolume(Callback callback, MountedVolumesFlags flags = NoFlags);
     static QStorageInfo root();
+    static QHash<QString, QStorageInfo> forPaths(const QStringList &paths);
+    static FileSystemTraits fileSystemTraits(const QByteArray &fileSystemType);
+
+    static int queryTimeout();
+    static void setQueryTimeout(int msecs);
+
+    static QStorageStatistics statistics();
+    static bool isStatisticsEnabled();
+    static void setStatisticsEnabled(bool enable);
+    static void resetStatistics();
 
 private:
+    explicit QStorageInfo(QStorageInfoPrivate &dd);
+
+    template <typename Callback>
+    static bool invokeVolumeCallback(const QStorageInfo &volume, void *context)
+    { return (*static_cast<Callback *>(context))(volume); }
+
     friend class QStorageInfoPrivate;
     friend bool operator==(const QStorageInfo &first, const QStorageInfo &second);
     QExplicitlySharedDataPointer<QStorageInfoPrivate> d;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(QStorageInfo::MountedVolumesFlags)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QStorageInfo::FileSystemTraits)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QStorageInfo::MountFlags)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QStorageInfo::DeviceFlags)
+
+template <typename Callback>
+inline void QStorageInfo::forEachMountedVolume(Callback callback, MountedVolumesFlags flags)
+{
+    forEachMountedVolume(&QStorageInfo::invokeVolumeCallback<Callback>, &callback, flags);
+}
+
 inline bool operator==(const QStorageInfo &first, const QStorageInfo &second)
 {
     if (first.d == second.d)
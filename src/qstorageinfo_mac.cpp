@@ -39,6 +39,7 @@
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreFoundation/CFURLEnumerator.h>
 
+#include <limits.h>
 #include <sys/mount.h>
 
 #define QT_STATFSBUF struct statfs
@@ -68,6 +69,12 @@ void QStorageInfoPrivate::doStat()
     retrieveUrlProperties();
 }
 
+void QStorageInfoPrivate::doStatSpace()
+{
+    retrievePosixInfo();
+    retrieveUrlProperties();
+}
+
 void QStorageInfoPrivate::retrievePosixInfo()
 {
     QT_STATFSBUF statfs_buf;
@@ -75,6 +82,26 @@ void QStorageInfoPrivate::retrievePosixInfo()
     if (result == 0) {
         device = QByteArray(statfs_buf.f_mntfromname);
         readOnly = (statfs_buf.f_flags & MNT_RDONLY) != 0;
+        filesTotal = statfs_buf.f_files;
+        filesFree = statfs_buf.f_ffree;
+        filesAvailable = statfs_buf.f_ffree;
+        fragmentSize = int(statfs_buf.f_bsize);
+        blockSize = int(statfs_buf.f_iosize);
+        maximumFileNameLength = NAME_MAX;
+
+        mountFlags = 0;
+        if (statfs_buf.f_flags & MNT_RDONLY)
+            mountFlags |= QStorageInfo::ReadOnlyMount;
+        if (statfs_buf.f_flags & MNT_NOSUID)
+            mountFlags |= QStorageInfo::NoSuidMount;
+        if (statfs_buf.f_flags & MNT_NODEV)
+            mountFlags |= QStorageInfo::NoDevMount;
+        if (statfs_buf.f_flags & MNT_NOEXEC)
+            mountFlags |= QStorageInfo::NoExecMount;
+        if (statfs_buf.f_flags & MNT_SYNCHRONOUS)
+            mountFlags |= QStorageInfo::SynchronousMount;
+        if (statfs_buf.f_flags & MNT_NOATIME)
+            mountFlags |= QStorageInfo::NoAtimeMount;
         fileSystemType = QByteArray(statfs_buf.f_fstypename);
     }
 }
@@ -47,21 +47,147 @@
 
 #include "qstorageinfo.h"
 
+#include <QtCore/qmutex.h>
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+#include <QtCore/qhash.h>
+#include <QtCore/qvector.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+struct QStorageMountEntry
+{
+    inline QStorageMountEntry() :
+        mountId(-1), parentMountId(-1), deviceMajor(-1), deviceMinor(-1), pseudo(false)
+    {}
+
+    QString rootPath;
+    QByteArray device;
+    QByteArray fileSystemType;
+    QByteArray options;
+    QByteArray fileSystemRoot;
+    QByteArray optionalFields;
+    int mountId;
+    int parentMountId;
+    int deviceMajor;
+    int deviceMinor;
+    bool pseudo;
+};
+Q_DECLARE_TYPEINFO(QStorageMountEntry, Q_MOVABLE_TYPE);
+
+// An immutable copy of the mount table. Copies are cheap, so every reader
+// takes its own and never has to hold a lock while walking the entries.
+struct QStorageMountTable
+{
+    inline QStorageMountTable() : generation(0), valid(false) {}
+
+    void buildIndex();
+    int findVolume(const QString &path) const;
+
+    QVector<QStorageMountEntry> entries;
+    QHash<QString, int> mountPoints;
+    QMultiHash<quint64, int> devices;
+    quint64 generation;
+    bool valid;
+};
+
+// What a statvfs() replacement set for testing reports about a volume.
+struct QStorageStatInfo
+{
+    inline QStorageStatInfo() :
+        bytesTotal(-1), bytesFree(-1), bytesAvailable(-1),
+        filesTotal(-1), filesFree(-1), filesAvailable(-1),
+        blockSize(-1), fragmentSize(-1), maximumFileNameLength(-1),
+        mountFlags(0), readOnly(false)
+    {}
+
+    qint64 bytesTotal;
+    qint64 bytesFree;
+    qint64 bytesAvailable;
+    qint64 filesTotal;
+    qint64 filesFree;
+    qint64 filesAvailable;
+    int blockSize;
+    int fragmentSize;
+    int maximumFileNameLength;
+    uint mountFlags; // QStorageInfo::MountFlags
+    bool readOnly;
+};
+
+// Returns false if the volume at rootPath cannot be queried.
+typedef bool (*QStorageStatFunction)(const QByteArray &rootPath, QStorageStatInfo *info);
+
+// For tests and benchmarks: replaces the statvfs() calls of QStorageInfo,
+// or restores them if function is null. The function is called where
+// statvfs() would be, by a worker thread if a query timeout is set, so a
+// function that blocks simulates a volume that does not answer.
+QSTORAGEINFO_EXPORT void qt_storage_setStatFunction(QStorageStatFunction function);
+
+#if defined(Q_OS_LINUX)
+// For tests and benchmarks: makes labels and UUIDs be read from the by-label,
+// by-uuid and by-partuuid directories below path instead of /dev/disk, or
+// from /dev/disk again if path is empty.
+QSTORAGEINFO_EXPORT void qt_storage_setDeviceLinkRoot(const QString &path);
+
+// For tests: makes the queue limits of block devices be read from the
+// MAJOR:MINOR directories below path instead of /sys/dev/block, or from
+// /sys/dev/block again if path is empty.
+QSTORAGEINFO_EXPORT void qt_storage_setBlockDeviceRoot(const QString &path);
+#endif
+#endif
+
 class QStorageInfoPrivate : public QSharedData
 {
 public:
+    // the parts of the information that are retrieved on first access
+    enum Field {
+        VolumeInfoField = 0x1, // statvfs() results, ready and valid flags
+        LabelField = 0x2,      // name, uuid and partitionUuid
+        IoGeometryField = 0x4, // st_blksize and the queue limits of the device
+        AllFields = VolumeInfoField | LabelField | IoGeometryField
+    };
+
     inline QStorageInfoPrivate() : QSharedData(),
+        mountId(-1), parentMountId(-1), deviceMajor(-1), deviceMinor(-1),
         bytesTotal(-1), bytesFree(-1), bytesAvailable(-1),
-        readOnly(false), ready(false), valid(false)
+        filesTotal(-1), filesFree(-1), filesAvailable(-1),
+        blockSize(-1), fragmentSize(-1), maximumFileNameLength(-1), mountFlags(0),
+        ioBlockSize(-1), logicalBlockSize(-1), physicalBlockSize(-1),
+        minimumIoSize(-1), optimalIoSize(-1),
+        maximumTransferSize(-1), discardGranularity(-1), deviceFlags(0),
+        readOnly(false), ready(false), valid(false), timedOut(false),
+        fetched(0)
     {}
+    ~QStorageInfoPrivate();
+
+    void assign(const QStorageInfoPrivate &other);
+    void assignVolumeInfo(const QStorageInfoPrivate &other);
+    void assignIoGeometry(const QStorageInfoPrivate &other);
+    void fetch(uint fields, QMutexLocker *locker);
 
     void initRootPath();
     void doStat();
+    void doStatSpace();
 
     static QList<QStorageInfo> mountedVolumes();
     static QStorageInfo root();
+    static uint fileSystemTraits(const QByteArray &type, const QByteArray &device);
+
+    static QBasicAtomicInt queryTimeout;
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    static QStorageMountTable mountTable();
+    void setMountEntry(const QStorageMountEntry &entry);
+    static QStorageInfo fromMountEntry(const QStorageMountEntry &entry, bool retrieveInfo = true);
+    // drops the cached information, the next access queries the volume again
+    static void invalidate(const QStorageInfo &info);
+
+    static QExplicitlySharedDataPointer<QStorageInfoPrivate> volumeForPath(const QString &path);
+    static QExplicitlySharedDataPointer<QStorageInfoPrivate> volumeForEntry(const QStorageMountEntry &entry);
+    void unregisterVolume();
+#endif
 
 protected:
 #if defined(Q_OS_WIN) && !defined(Q_OS_WINCE) && !defined(Q_OS_WINRT)
@@ -73,21 +199,60 @@ protected:
     void retrieveLabel();
 #elif defined(Q_OS_UNIX)
     void retrieveVolumeInfo();
+    void retrieveLabel();
+    void retrieveIoGeometry();
 #endif
 
 public:
+    // guards the fields below while the object is shared
+    mutable QMutex mutex;
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    QByteArray registryKey;
+#endif
+
     QString rootPath;
     QByteArray device;
     QByteArray fileSystemType;
     QString name;
+    QByteArray uuid;
+    QByteArray partitionUuid;
+    QByteArray fileSystemRoot;
+    QByteArray optionalFields;
+
+    int mountId;
+    int parentMountId;
+    int deviceMajor;
+    int deviceMinor;
 
     qint64 bytesTotal;
     qint64 bytesFree;
     qint64 bytesAvailable;
 
+    // the rest of what statvfs() reports
+    qint64 filesTotal;
+    qint64 filesFree;
+    qint64 filesAvailable;
+    int blockSize;
+    int fragmentSize;
+    int maximumFileNameLength;
+    uint mountFlags;
+
+    // how the volume and the block device below it prefer to be accessed
+    int ioBlockSize;
+    int logicalBlockSize;
+    int physicalBlockSize;
+    int minimumIoSize;
+    int optimalIoSize;
+    qint64 maximumTransferSize;
+    qint64 discardGranularity;
+    uint deviceFlags;
+
     bool readOnly;
     bool ready;
     bool valid;
+    bool timedOut;
+
+    uint fetched; // the Fields that are up to date
 };
 
 QT_END_NAMESPACE
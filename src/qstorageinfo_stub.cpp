@@ -46,6 +46,11 @@ void QStorageInfoPrivate::doStat()
     Q_UNIMPLEMENTED();
 }
 
+void QStorageInfoPrivate::doStatSpace()
+{
+    Q_UNIMPLEMENTED();
+}
+
 QList<QStorageInfo> QStorageInfoPrivate::mountedVolumes()
 {
     Q_UNIMPLEMENTED();
@@ -32,10 +32,19 @@
 ****************************************************************************/
 
 #include "qstorageinfo_p.h"
+#include "qstorageiterator_p.h"
+#include "qstoragestatistics_p.h"
 
-#include <QtCore/qdiriterator.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qsharedpointer.h>
 #include <QtCore/qtextstream.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qwaitcondition.h>
 
 #include <QtCore/private/qcore_unix_p.h>
 
@@ -48,24 +57,22 @@
 #elif defined(Q_OS_ANDROID)
 #  include <sys/mount.h>
 #  include <sys/vfs.h>
-#  include <mntent.h>
-#elif defined(Q_OS_LINUX)
-#  include <mntent.h>
-#  include <sys/statvfs.h>
-#elif defined(Q_OS_SOLARIS)
-#  include <sys/mnttab.h>
-#  include <sys/statvfs.h>
 #elif defined(Q_OS_HAIKU)
-#  include <Directory.h>
-#  include <Path.h>
-#  include <Volume.h>
-#  include <VolumeRoster.h>
 #  include <fs_info.h>
 #  include <sys/statvfs.h>
 #else
 #  include <sys/statvfs.h>
 #endif
 
+#if defined(Q_OS_LINUX)
+#  include <dirent.h>
+#  include <poll.h>
+#  include <stdlib.h>
+#  include <string.h>
+#  include <sys/inotify.h>
+#  include <sys/sysmacros.h>
+#endif
+
 #if defined(Q_OS_BSD4)
 #  if defined(Q_OS_NETBSD)
      define QT_STATFSBUF struct statvfs
@@ -100,443 +107,1022 @@
 #  endif // QT_LARGEFILE_SUPPORT
 #endif // Q_OS_BSD4
 
+// The fields of QT_STATFSBUF beyond the block counts. The BSD statfs counts
+// blocks in f_bsize units and reports the preferred I/O size as f_iosize.
+#if defined(Q_OS_BSD4) && !defined(Q_OS_NETBSD)
+#  define QT_STATFS_FRSIZE(buf)  (buf).f_bsize
+#  define QT_STATFS_BSIZE(buf)   (buf).f_iosize
+#  define QT_STATFS_FAVAIL(buf)  (buf).f_ffree
+#  if defined(Q_OS_FREEBSD) || defined(Q_OS_OPENBSD)
+#    define QT_STATFS_NAMEMAX(buf) (buf).f_namemax
+#  endif
+#  define QT_STATFS_FLAGS(buf)   (buf).f_flags
+#elif defined(Q_OS_ANDROID)
+#  define QT_STATFS_FRSIZE(buf)  (buf).f_frsize
+#  define QT_STATFS_BSIZE(buf)   (buf).f_bsize
+#  define QT_STATFS_FAVAIL(buf)  (buf).f_ffree
+#  define QT_STATFS_NAMEMAX(buf) (buf).f_namelen
+#  if defined(_STATFS_F_FLAGS)
+#    define QT_STATFS_FLAGS(buf) (buf).f_flags
+#  endif
+#else
+#  define QT_STATFS_FRSIZE(buf)  (buf).f_frsize
+#  define QT_STATFS_BSIZE(buf)   (buf).f_bsize
+#  define QT_STATFS_FAVAIL(buf)  (buf).f_favail
+#  define QT_STATFS_NAMEMAX(buf) (buf).f_namemax
+#  define QT_STATFS_FLAGS(buf)   (buf).f_flag
+#endif
+
 QT_BEGIN_NAMESPACE
 
-static bool isPseudoFs(const QString &mountDir, const QByteArray &type)
+static bool isPseudoFs(const QString &mountDir, const QByteArray &type, const QByteArray &device)
 {
-    if (mountDir.startsWith(QLatin1String("/dev"))
-        || mountDir.startsWith(QLatin1String("/proc"))
-        || mountDir.startsWith(QLatin1String("/sys"))
-        || mountDir.startsWith(QLatin1String("/var/run"))
-        || mountDir.startsWith(QLatin1String("/var/lock"))) {
-        return true;
-    }
-    if (type == "tmpfs")
-        return true;
-#if defined(Q_OS_LINUX)
-    if (type == "rootfs" || type == "rpc_pipefs")
-        return true;
-#endif
-
-    return false;
+    if (!(QStorageInfoPrivate::fileSystemTraits(type, device) & QStorageInfo::PseudoFileSystem))
+        return false;
+    // whatever is mounted on / is a real volume, except for the initramfs
+    // that is hidden below it
+    return mountDir != QLatin1String("/") || type == "rootfs";
 }
 
-class QStorageIterator
+// Keeps the current mount table snapshot for the whole process. On Linux the
+// kernel reports every change of the mount namespace as POLLPRI/POLLERR on an
+// open /proc/self/mounts descriptor, so the table is only read again after
+// such a notification. Elsewhere we cannot tell and read it on every call.
+class QStorageMountTableCache
 {
 public:
-    QStorageIterator();
-    ~QStorageIterator();
-
-    inline bool isValid() const;
-    inline bool next();
-    inline QString rootPath() const;
-    inline QByteArray fileSystemType() const;
-    inline QByteArray device() const;
+    QStorageMountTableCache();
+    ~QStorageMountTableCache();
+
+    QStorageMountTable current();
+
+    static QStorageMountTable read(quint64 generation);
+
 private:
-#if defined(Q_OS_BSD4)
-    QT_STATFSBUF *stat_buf;
-    int entryCount;
-    int currentIndex;
-#elif defined(Q_OS_SOLARIS)
-    FILE *fp;
-    mnttab mnt;
-#elif defined(Q_OS_ANDROID)
-    QFile file;
-    QByteArray m_rootPath;
-    QByteArray m_fileSystemType;
-    QByteArray m_device;
-#elif defined(Q_OS_LINUX)
-    FILE *fp;
-    mntent mnt;
-    QByteArray buffer;
-#elif defined(Q_OS_HAIKU)
-    BVolumeRoster m_volumeRoster;
+    bool hasChanged();
 
-    QByteArray m_rootPath;
-    QByteArray m_fileSystemType;
-    QByteArray m_device;
-#endif
+    QMutex mutex;
+    QStorageMountTable table;
+    int notifierFd;
+    int sourceSerial;
 };
 
-#if defined(Q_OS_BSD4)
+#if defined(Q_OS_LINUX)
+static const char pathMountsNotifier[] = "/proc/self/mounts";
+#endif
 
-inline QStorageIterator::QStorageIterator()
-    : entryCount(::getmntinfo(&stat_buf, 0)),
-      currentIndex(-1)
+QStorageMountTableCache::QStorageMountTableCache() :
+    notifierFd(-1),
+    sourceSerial(0)
 {
+#if defined(Q_OS_LINUX)
+    notifierFd = qt_safe_open(pathMountsNotifier, O_RDONLY);
+    QStorageStatisticsCollector::count(QStorageStatistics::FilesOpened);
+#endif
 }
 
-inline QStorageIterator::~QStorageIterator()
+QStorageMountTableCache::~QStorageMountTableCache()
 {
+    if (notifierFd != -1)
+        qt_safe_close(notifierFd);
 }
 
-inline bool QStorageIterator::isValid() const
+QStorageMountTable QStorageMountTableCache::current()
 {
-    return entryCount != -1;
+    QMutexLocker locker(&mutex);
+    if (hasChanged()) {
+        QStorageStatisticsCollector::count(QStorageStatistics::CacheMisses);
+        table = read(table.generation + 1);
+    } else {
+        QStorageStatisticsCollector::count(QStorageStatistics::CacheHits);
+    }
+    return table;
 }
 
-inline bool QStorageIterator::next()
+QStorageMountTable QStorageMountTableCache::read(quint64 generation)
 {
-    return ++currentIndex < entryCount;
-}
+    QStoragePhaseTimer timer(QStorageStatistics::MountTablePhase);
 
-inline QString QStorageIterator::rootPath() const
-{
-    return QFile::decodeName(stat_buf[currentIndex].f_mntonname);
-}
+    QStorageMountTable result;
+    result.generation = generation;
 
-inline QByteArray QStorageIterator::fileSystemType() const
-{
-    return QByteArray(stat_buf[currentIndex].f_fstypename);
+    QStorageIterator it;
+    result.valid = it.isValid();
+    if (!result.valid)
+        return result;
+
+    while (it.next()) {
+        QStorageMountEntry entry;
+        entry.rootPath = QFile::decodeName(it.rootPath());
+        entry.device = QByteArray(it.device());
+        entry.fileSystemType = QByteArray(it.fileSystemType());
+        entry.options = QByteArray(it.options());
+        if (*it.superOptions()) {
+            // per mount options followed by the ones of the superblock, like mtab
+            entry.options += ',';
+            entry.options += it.superOptions();
+        }
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+        entry.mountId = it.mountId();
+        entry.parentMountId = it.parentMountId();
+        entry.deviceMajor = it.majorDeviceNumber();
+        entry.deviceMinor = it.minorDeviceNumber();
+        entry.fileSystemRoot = QByteArray(it.fileSystemRoot());
+        entry.optionalFields = QByteArray(it.optionalFields());
+#endif
+        entry.pseudo = isPseudoFs(entry.rootPath, entry.fileSystemType, entry.device);
+        result.entries.append(entry);
+    }
+
+    result.buildIndex();
+    return result;
 }
 
-inline QByteArray QStorageIterator::device() const
+bool QStorageMountTableCache::hasChanged()
 {
-    return QByteArray(stat_buf[currentIndex].f_mntfromname);
-}
+#if defined(Q_OS_LINUX)
+    // a mount table set for testing only changes when it is set again
+    const int serial = qt_storage_mountTableSerial();
+    if (serial != sourceSerial) {
+        sourceSerial = serial;
+        return true;
+    }
+    if (qt_storage_hasMountTableOverride())
+        return table.generation == 0;
+#endif
+
+    if (table.generation == 0 || notifierFd == -1)
+        return true;
 
-#elif defined(Q_OS_SOLARIS)
+#if defined(Q_OS_LINUX)
+    // polling also acknowledges the event, so it is reported only once
+    pollfd pfd;
+    pfd.fd = notifierFd;
+    pfd.events = POLLPRI;
+    pfd.revents = 0;
+    int result;
+    EINTR_LOOP(result, ::poll(&pfd, 1, 0));
+    return result != 0 && (result == -1 || (pfd.revents & (POLLPRI | POLLERR)) != 0);
+#else
+    return true;
+#endif
+}
 
-static const char pathMounted[] = "/etc/mnttab";
+Q_GLOBAL_STATIC(QStorageMountTableCache, mountTableCache)
 
-inline QStorageIterator::QStorageIterator()
+QStorageMountTable QStorageInfoPrivate::mountTable()
 {
-    const int fd = qt_safe_open(pathMounted, O_RDONLY);
-    fp = ::fdopen(fd, "r");
+    if (QStorageMountTableCache *cache = mountTableCache())
+        return cache->current();
+    return QStorageMountTableCache::read(0);
 }
 
-inline QStorageIterator::~QStorageIterator()
+static inline quint64 deviceKey(int major, int minor)
 {
-    if (fp)
-        ::fclose(fp);
+    return (quint64(quint32(major)) << 32) | quint32(minor);
 }
 
-inline bool QStorageIterator::isValid() const
+void QStorageMountTable::buildIndex()
 {
-    return fp != Q_NULLPTR;
+    mountPoints.reserve(entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        const QStorageMountEntry &entry = entries.at(i);
+        if (entry.pseudo)
+            continue;
+        // a later mount on the same directory hides the earlier one
+        mountPoints.insert(entry.rootPath, i);
+        if (entry.deviceMajor != -1)
+            devices.insert(deviceKey(entry.deviceMajor, entry.deviceMinor), i);
+    }
 }
 
-inline bool QStorageIterator::next()
+static inline bool isParentPath(const QString &parent, const QString &path)
 {
-    return ::getmntent(fp, &mnt) == 0;
+    if (!path.startsWith(parent))
+        return false;
+    return path.size() == parent.size()
+            || parent.endsWith(QLatin1Char('/'))
+            || path.at(parent.size()) == QLatin1Char('/');
 }
 
-inline QString QStorageIterator::rootPath() const
+int QStorageMountTable::findVolume(const QString &path) const
 {
-    return QFile::decodeName(mnt.mnt_mountp);
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+    // Usually only one mount has the device of the path. Bind mounts share
+    // the device with the mount they come from, so pick the deepest of them
+    // that contains the path.
+    if (!devices.isEmpty()) {
+        struct stat st;
+        if (::stat(QFile::encodeName(path).constData(), &st) == 0) {
+            int result = -1;
+            int resultLength = -1;
+            const quint64 key = deviceKey(int(major(st.st_dev)), int(minor(st.st_dev)));
+            QMultiHash<quint64, int>::const_iterator it = devices.constFind(key);
+            for (; it != devices.constEnd() && it.key() == key; ++it) {
+                const QString &mountPoint = entries.at(it.value()).rootPath;
+                if (!isParentPath(mountPoint, path))
+                    continue;
+                if (mountPoint.size() > resultLength
+                        || (mountPoint.size() == resultLength && it.value() > result)) {
+                    result = it.value();
+                    resultLength = mountPoint.size();
+                }
+            }
+            if (result != -1)
+                return result;
+        }
+    }
+#endif
+
+    // Either there are no device numbers, or the filesystem reports devices
+    // of its own (btrfs subvolumes, overlays): walk up to the closest mount
+    // point instead.
+    QString current = path;
+    for (;;) {
+        QHash<QString, int>::const_iterator it = mountPoints.constFind(current);
+        if (it != mountPoints.constEnd())
+            return it.value();
+        if (current.size() <= 1)
+            return -1;
+        const int slash = current.lastIndexOf(QLatin1Char('/'));
+        current.truncate(slash > 0 ? slash : 1);
+    }
 }
 
-inline QByteArray QStorageIterator::fileSystemType() const
+void QStorageInfoPrivate::initRootPath()
 {
-    return QByteArray(mnt.mnt_fstype);
+    QStoragePhaseTimer timer(QStorageStatistics::CanonicalPathPhase);
+    rootPath = QFileInfo(rootPath).canonicalFilePath();
+    timer.stop();
+
+    if (rootPath.isEmpty())
+        return;
+
+    const QStorageMountTable table = mountTable();
+    if (!table.valid) {
+        rootPath = QStringLiteral("/");
+        return;
+    }
+
+    const int index = table.findVolume(rootPath);
+    rootPath.clear();
+    if (index != -1)
+        setMountEntry(table.entries.at(index));
 }
 
-inline QByteArray QStorageIterator::device() const
+void QStorageInfoPrivate::setMountEntry(const QStorageMountEntry &entry)
 {
-    return QByteArray(mnt.mnt_mntopts);
+    rootPath = entry.rootPath;
+    device = entry.device;
+    fileSystemType = entry.fileSystemType;
+    fileSystemRoot = entry.fileSystemRoot;
+    optionalFields = entry.optionalFields;
+    mountId = entry.mountId;
+    parentMountId = entry.parentMountId;
+    deviceMajor = entry.deviceMajor;
+    deviceMinor = entry.deviceMinor;
 }
 
-#elif defined(Q_OS_ANDROID)
-
-static const char pathMounted[] = "/proc/mounts";
+#if defined(Q_OS_LINUX)
 
-inline QStorageIterator::QStorageIterator()
+// Maps devices to the names udev gives them in /dev/disk/by-*. All links are
+// read in one pass and the index is only rebuilt after inotify reports that
+// one of the directories has changed.
+class QStorageDeviceIndex
 {
-    file.setFileName(pathMounted);
-    file.open(QIODevice::ReadOnly | QIODevice::Text);
-}
+public:
+    struct Entry
+    {
+        QString label;
+        QByteArray uuid;
+        QByteArray partUuid;
+    };
+
+    QStorageDeviceIndex();
+    ~QStorageDeviceIndex();
+
+    Entry entry(const QByteArray &device);
+    void setRoot(const QByteArray &path);
+
+private:
+    bool hasChanged();
+    void rebuild();
+
+    QMutex mutex;
+    QHash<QByteArray, Entry> entries;
+    QByteArray root;
+    int inotifyFd;
+    bool dirty;
+};
+
+static const char pathDisk[] = "/dev/disk";
 
-inline QStorageIterator::~QStorageIterator()
+QStorageDeviceIndex::QStorageDeviceIndex() :
+    root(pathDisk),
+    inotifyFd(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+    dirty(true)
 {
 }
 
-inline bool QStorageIterator::isValid() const
+QStorageDeviceIndex::~QStorageDeviceIndex()
 {
-    return file.isOpen();
+    if (inotifyFd != -1)
+        qt_safe_close(inotifyFd);
 }
 
-inline bool QStorageIterator::next()
+QStorageDeviceIndex::Entry QStorageDeviceIndex::entry(const QByteArray &device)
 {
-    QList<QByteArray> data;
-    do {
-        const QByteArray line = file.readLine();
-        data = line.split(' ');
-    } while (data.count() < 3 && !file.atEnd());
+    QMutexLocker locker(&mutex);
+    if (hasChanged()) {
+        QStorageStatisticsCollector::count(QStorageStatistics::CacheMisses);
+        rebuild();
+    } else {
+        QStorageStatisticsCollector::count(QStorageStatistics::CacheHits);
+    }
 
-    if (file.atEnd())
-        return false;
-    m_device = data.at(0);
-    m_rootPath = data.at(1);
-    m_fileSystemType = data.at(2);
+    QHash<QByteArray, Entry>::const_iterator it = entries.constFind(device);
+    if (it != entries.constEnd())
+        return it.value();
 
-    return true;
+    // devices like /dev/mapper/* or /dev/disk/by-uuid/* are links themselves
+    if (device.startsWith("/dev/")) {
+        const QByteArray target =
+                QFile::encodeName(QFileInfo(QFile::decodeName(device)).canonicalFilePath());
+        if (!target.isEmpty() && target != device)
+            return entries.value(target);
+    }
+    return Entry();
 }
 
-inline QString QStorageIterator::rootPath() const
+void QStorageDeviceIndex::setRoot(const QByteArray &path)
 {
-    return QFile::decodeName(m_rootPath);
+    QMutexLocker locker(&mutex);
+    root = path.isEmpty() ? QByteArray(pathDisk) : path;
+    dirty = true;
 }
 
-inline QByteArray QStorageIterator::fileSystemType() const
+bool QStorageDeviceIndex::hasChanged()
 {
-    return m_fileSystemType;
-}
+    // without inotify we cannot tell whether the index is still current
+    if (inotifyFd == -1)
+        return true;
 
-inline QByteArray QStorageIterator::device() const
-{
-    return m_device;
-}
+    bool changed = dirty;
+    dirty = false;
 
-#elif defined(Q_OS_LINUX)
+    // we only care whether something happened, not what it was
+    char buffer[4096];
+    while (qt_safe_read(inotifyFd, buffer, sizeof(buffer)) > 0)
+        changed = true;
 
-static const char pathMounted[] = "/etc/mtab";
-static const int bufferSize = 3*PATH_MAX; // 2 paths (mount point+device) and metainfo
+    return changed;
+}
 
-inline QStorageIterator::QStorageIterator() :
-    buffer(QByteArray(bufferSize, 0))
+static QByteArray linkTarget(const QByteArray &directory, const char *name)
 {
-    fp = ::setmntent(pathMounted, "r");
+    char buffer[PATH_MAX];
+    const QByteArray link = directory + '/' + name;
+    const ssize_t length = ::readlink(link.constData(), buffer, sizeof(buffer));
+    QStorageStatisticsCollector::count(QStorageStatistics::LinksRead);
+    if (length <= 0 || length == ssize_t(sizeof(buffer)))
+        return QByteArray();
+
+    QByteArray target(buffer, int(length));
+    if (!target.startsWith('/'))
+        target = directory + '/' + target;
+    return QFile::encodeName(QDir::cleanPath(QFile::decodeName(target)));
 }
 
-inline QStorageIterator::~QStorageIterator()
+void QStorageDeviceIndex::rebuild()
 {
-    if (fp)
-        ::endmntent(fp);
+    enum Kind { Label, Uuid, PartUuid };
+    static const char *const directories[] = {
+        "/by-label",
+        "/by-uuid",
+        "/by-partuuid"
+    };
+    static const uint32_t watchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+            | IN_DELETE_SELF | IN_MOVE_SELF;
+
+    QStoragePhaseTimer timer(QStorageStatistics::DeviceLinkPhase);
+    entries.clear();
+
+    // Watches are (re)added before reading so that no change can slip in
+    // between; adding an existing watch again is harmless.
+    if (inotifyFd != -1)
+        ::inotify_add_watch(inotifyFd, root.constData(), watchMask);
+
+    for (int kind = Label; kind <= PartUuid; ++kind) {
+        const QByteArray directory = root + directories[kind];
+        if (inotifyFd != -1)
+            ::inotify_add_watch(inotifyFd, directory.constData(), watchMask);
+
+        DIR *dir = ::opendir(directory.constData());
+        QStorageStatisticsCollector::count(QStorageStatistics::FilesOpened);
+        if (!dir)
+            continue;
+
+        while (struct dirent *dirEntry = ::readdir(dir)) {
+            if (dirEntry->d_name[0] == '.')
+                continue;
+
+            const QByteArray device = linkTarget(directory, dirEntry->d_name);
+            if (device.isEmpty())
+                continue;
+
+            Entry &entry = entries[device];
+            if (kind == Label)
+                entry.label = QFile::decodeName(dirEntry->d_name);
+            else if (kind == Uuid)
+                entry.uuid = dirEntry->d_name;
+            else
+                entry.partUuid = dirEntry->d_name;
+        }
+        ::closedir(dir);
+    }
 }
 
-inline bool QStorageIterator::isValid() const
+Q_GLOBAL_STATIC(QStorageDeviceIndex, deviceIndex)
+
+void qt_storage_setDeviceLinkRoot(const QString &path)
 {
-    return fp != Q_NULLPTR;
+    if (QStorageDeviceIndex *index = deviceIndex())
+        index->setRoot(QFile::encodeName(path));
 }
 
-inline bool QStorageIterator::next()
+static const char pathBlockDevices[] = "/sys/dev/block";
+
+struct QStorageBlockDeviceRoot
 {
-    return ::getmntent_r(fp, &mnt, buffer.data(), buffer.size()) != Q_NULLPTR;
-}
+    QMutex mutex;
+    QByteArray path;
+};
+
+Q_GLOBAL_STATIC(QStorageBlockDeviceRoot, blockDeviceRoot)
 
-inline QString QStorageIterator::rootPath() const
+void qt_storage_setBlockDeviceRoot(const QString &path)
 {
-    return QFile::decodeName(mnt.mnt_dir);
+    if (QStorageBlockDeviceRoot *root = blockDeviceRoot()) {
+        QMutexLocker locker(&root->mutex);
+        root->path = QFile::encodeName(path);
+    }
 }
 
-inline QByteArray QStorageIterator::fileSystemType() const
+// Returns the contents of a sysfs attribute without the trailing newline.
+static QByteArray readAttribute(const QByteArray &path)
 {
-    return QByteArray(mnt.mnt_type);
+    const int fd = qt_safe_open(path.constData(), O_RDONLY);
+    QStorageStatisticsCollector::count(QStorageStatistics::FilesOpened);
+    if (fd == -1)
+        return QByteArray();
+
+    char buffer[64];
+    const qint64 length = qt_safe_read(fd, buffer, sizeof(buffer));
+    qt_safe_close(fd);
+    if (length <= 0)
+        return QByteArray();
+    return QByteArray(buffer, int(length)).trimmed();
 }
 
-inline QByteArray QStorageIterator::device() const
+static qint64 readNumberAttribute(const QByteArray &path)
 {
-    return QByteArray(mnt.mnt_fsname);
+    bool ok;
+    const qint64 value = readAttribute(path).toLongLong(&ok);
+    return ok ? value : -1;
 }
 
-#elif defined(Q_OS_HAIKU)
-inline QStorageIterator::QStorageIterator()
+#endif // Q_OS_LINUX
+
+void QStorageInfoPrivate::retrieveLabel()
 {
+#ifdef Q_OS_LINUX
+    if (QStorageDeviceIndex *index = deviceIndex()) {
+        const QStorageDeviceIndex::Entry entry = index->entry(device);
+        name = entry.label;
+        uuid = entry.uuid;
+        partitionUuid = entry.partUuid;
+    }
+#elif defined Q_OS_HAIKU
+    fs_info fsInfo;
+    memset(&fsInfo, 0, sizeof(fsInfo));
+
+    int32 pos = 0;
+    dev_t dev;
+    while ((dev = next_dev(&pos)) >= 0) {
+        if (fs_stat_dev(dev, &fsInfo) != 0)
+            continue;
+
+        if (qstrcmp(fsInfo.device_name, device.constData()) == 0) {
+            name = QString::fromLocal8Bit(fsInfo.volume_name);
+            return;
+        }
+    }
+#endif
 }
 
-inline QStorageIterator::~QStorageIterator()
+void QStorageInfoPrivate::doStat()
 {
+    // the volume information and the label are retrieved on first access
+    initRootPath();
+    fetched = 0;
 }
 
-inline bool QStorageIterator::isValid() const
+void QStorageInfoPrivate::doStatSpace()
 {
-    return true;
+    retrieveVolumeInfo();
 }
 
-inline bool QStorageIterator::next()
-{
-    BVolume volume;
+static QBasicAtomicPointer<void> statFunction = Q_BASIC_ATOMIC_INITIALIZER(Q_NULLPTR);
 
-    if (m_volumeRoster.GetNextVolume(&volume) != B_OK)
-        return false;
+void qt_storage_setStatFunction(QStorageStatFunction function)
+{
+    statFunction.store(reinterpret_cast<void *>(function));
+}
 
-    BDirectory directory;
-    if (volume.GetRootDirectory(&directory) != B_OK)
-        return false;
+#if defined(QT_STATFS_FLAGS)
+static const struct {
+    unsigned long nativeFlag;
+    uint mountFlag;
+} mountFlagTable[] = {
+    { ST_RDONLY, QStorageInfo::ReadOnlyMount },
+#if defined(Q_OS_BSD4)
+#  if defined(MNT_NOSUID)
+    { MNT_NOSUID, QStorageInfo::NoSuidMount },
+#  endif
+#  if defined(MNT_NODEV)
+    { MNT_NODEV, QStorageInfo::NoDevMount },
+#  endif
+#  if defined(MNT_NOEXEC)
+    { MNT_NOEXEC, QStorageInfo::NoExecMount },
+#  endif
+#  if defined(MNT_SYNCHRONOUS)
+    { MNT_SYNCHRONOUS, QStorageInfo::SynchronousMount },
+#  endif
+#  if defined(MNT_NOATIME)
+    { MNT_NOATIME, QStorageInfo::NoAtimeMount },
+#  endif
+#else
+#  if defined(ST_NOSUID)
+    { ST_NOSUID, QStorageInfo::NoSuidMount },
+#  endif
+#  if defined(ST_NODEV)
+    { ST_NODEV, QStorageInfo::NoDevMount },
+#  endif
+#  if defined(ST_NOEXEC)
+    { ST_NOEXEC, QStorageInfo::NoExecMount },
+#  endif
+#  if defined(ST_SYNCHRONOUS)
+    { ST_SYNCHRONOUS, QStorageInfo::SynchronousMount },
+#  endif
+#  if defined(ST_MANDLOCK)
+    { ST_MANDLOCK, QStorageInfo::MandatoryLockMount },
+#  endif
+#  if defined(ST_NOATIME)
+    { ST_NOATIME, QStorageInfo::NoAtimeMount },
+#  endif
+#  if defined(ST_NODIRATIME)
+    { ST_NODIRATIME, QStorageInfo::NoDirAtimeMount },
+#  endif
+#  if defined(ST_RELATIME)
+    { ST_RELATIME, QStorageInfo::RelAtimeMount },
+#  endif
+#endif // Q_OS_BSD4
+};
 
-    const BPath path(&directory);
+static uint toMountFlags(unsigned long nativeFlags)
+{
+    uint flags = 0;
+    for (size_t i = 0; i < sizeof(mountFlagTable) / sizeof(mountFlagTable[0]); ++i) {
+        if (nativeFlags & mountFlagTable[i].nativeFlag)
+            flags |= mountFlagTable[i].mountFlag;
+    }
+    return flags;
+}
+#endif // QT_STATFS_FLAGS
 
-    fs_info fsInfo;
-    memset(&fsInfo, 0, sizeof(fsInfo));
+// Queries the volume at path with statfs, or with the replacement set for
+// testing, which may block just like statfs.
+static bool statVolume(const QByteArray &path, QStorageStatInfo *info)
+{
+    if (void *function = statFunction.load())
+        return reinterpret_cast<QStorageStatFunction>(function)(path, info);
 
-    if (fs_stat_dev(volume.Device(), &fsInfo) != 0)
+    QT_STATFSBUF statfs_buf;
+    int result;
+    EINTR_LOOP(result, QT_STATFS(path.constData(), &statfs_buf));
+    if (result != 0)
         return false;
 
-    m_rootPath = path.Path();
-    m_fileSystemType = QByteArray(fsInfo.fsh_name);
-
-    const QByteArray deviceName(fsInfo.device_name);
-    m_device = (deviceName.isEmpty() ? QByteArray::number(qint32(volume.Device())) : deviceName);
-
+    // the block counts are in units of the fragment size
+    const qint64 unit = QT_STATFS_FRSIZE(statfs_buf);
+    info->bytesTotal = statfs_buf.f_blocks * unit;
+    info->bytesFree = statfs_buf.f_bfree * unit;
+    info->bytesAvailable = statfs_buf.f_bavail * unit;
+    info->filesTotal = statfs_buf.f_files;
+    info->filesFree = statfs_buf.f_ffree;
+    info->filesAvailable = QT_STATFS_FAVAIL(statfs_buf);
+    info->fragmentSize = int(unit);
+    info->blockSize = int(QT_STATFS_BSIZE(statfs_buf));
+#if defined(QT_STATFS_NAMEMAX)
+    info->maximumFileNameLength = int(QT_STATFS_NAMEMAX(statfs_buf));
+#endif
+#if defined(QT_STATFS_FLAGS)
+    info->mountFlags = toMountFlags(QT_STATFS_FLAGS(statfs_buf));
+#endif
     return true;
 }
 
-inline QString QStorageIterator::rootPath() const
+// Reports the st_blksize of path as blockSize.
+static bool statPath(const QByteArray &path, QStorageStatInfo *info)
 {
-    return QFile::decodeName(m_rootPath);
+    struct stat st;
+    if (::stat(path.constData(), &st) != 0)
+        return false;
+    info->blockSize = int(st.st_blksize);
+    return true;
 }
 
-inline QByteArray QStorageIterator::fileSystemType() const
+typedef bool (*QStorageQueryFunction)(const QByteArray &path, QStorageStatInfo *info);
+typedef QPair<quintptr, QByteArray> QStorageQueryKey;
+
+// A statfs or stat call on a filesystem whose server is gone may never
+// return, and the calling thread can't even be interrupted. With a query
+// timeout set, the call is made by a worker thread and the caller gives up
+// waiting when the timeout expires. The worker stays blocked until the kernel
+// lets it go and is then reused; callers asking for a path that is still
+// being queried wait for the pending request instead of occupying another
+// worker.
+struct QStorageStatRequest
 {
-    return m_fileSystemType;
-}
+    inline QStorageStatRequest() : done(false), ok(false) {}
+
+    QMutex mutex;
+    QWaitCondition finished;
+    bool done;
+    bool ok;
+    QStorageStatInfo info;
+};
 
-inline QByteArray QStorageIterator::device() const
+class QStorageStatWorkers
 {
-    return m_device;
-}
+public:
+    QStorageStatWorkers();
 
-#else
+    QSharedPointer<QStorageStatRequest> request(QStorageQueryFunction query, const QByteArray &path);
+    void finish(const QStorageQueryKey &key);
+
+    static QStorageStatWorkers *instance();
 
-inline QStorageIterator::QStorageIterator()
+private:
+    QThreadPool pool;
+    QMutex mutex;
+    QHash<QStorageQueryKey, QSharedPointer<QStorageStatRequest> > pending;
+};
+
+class QStorageStatTask : public QRunnable
 {
-}
+public:
+    inline QStorageStatTask(QStorageQueryFunction query, const QByteArray &path,
+                            const QSharedPointer<QStorageStatRequest> &request)
+        : query(query), path(path), request(request)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        QStorageStatInfo info;
+        const bool ok = query(path, &info);
+
+        QStorageStatWorkers::instance()->finish(QStorageQueryKey(quintptr(query), path));
+
+        QMutexLocker locker(&request->mutex);
+        request->ok = ok;
+        request->info = info;
+        request->done = true;
+        request->finished.wakeAll();
+    }
+
+private:
+    QStorageQueryFunction query;
+    QByteArray path;
+    QSharedPointer<QStorageStatRequest> request;
+};
 
-inline QStorageIterator::~QStorageIterator()
+QStorageStatWorkers::QStorageStatWorkers()
 {
+    // every hanging filesystem keeps one worker busy; leave enough for the
+    // healthy ones
+    pool.setMaxThreadCount(16);
 }
 
-inline bool QStorageIterator::isValid() const
+QSharedPointer<QStorageStatRequest> QStorageStatWorkers::request(QStorageQueryFunction query,
+                                                                 const QByteArray &path)
 {
-    return false;
+    QMutexLocker locker(&mutex);
+    QSharedPointer<QStorageStatRequest> &request = pending[QStorageQueryKey(quintptr(query), path)];
+    if (!request) {
+        request = QSharedPointer<QStorageStatRequest>(new QStorageStatRequest);
+        pool.start(new QStorageStatTask(query, path, request));
+    }
+    return request;
 }
 
-inline bool QStorageIterator::next()
+void QStorageStatWorkers::finish(const QStorageQueryKey &key)
 {
-    return false;
+    QMutexLocker locker(&mutex);
+    pending.remove(key);
 }
 
-inline QString QStorageIterator::rootPath() const
+QStorageStatWorkers *QStorageStatWorkers::instance()
 {
-    return QString();
+    // Deliberately leaked: destroying the pool waits for its threads, and a
+    // worker stuck on a dead server must not keep the process from exiting.
+    static QStorageStatWorkers *workers = new QStorageStatWorkers;
+    return workers;
 }
 
-inline QByteArray QStorageIterator::fileSystemType() const
+// Runs query for path and returns whether it succeeded, or false with
+// \a timedOut set if no answer came within the query timeout.
+static bool runQuery(QStorageQueryFunction query, const QByteArray &path,
+                     QStorageStatInfo *info, bool *timedOut)
 {
-    return QByteArray();
+    *timedOut = false;
+
+    const int timeout = QStorageInfoPrivate::queryTimeout.load();
+    if (timeout < 0)
+        return query(path, info);
+
+    const QSharedPointer<QStorageStatRequest> request =
+            QStorageStatWorkers::instance()->request(query, path);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QMutexLocker locker(&request->mutex);
+    while (!request->done) {
+        const qint64 remaining = timeout - timer.elapsed();
+        if (remaining <= 0 || !request->finished.wait(&request->mutex, ulong(remaining))) {
+            if (request->done)
+                break;
+            *timedOut = true;
+            return false;
+        }
+    }
+
+    *info = request->info;
+    return request->ok;
 }
 
-inline QByteArray QStorageIterator::device() const
+void QStorageInfoPrivate::retrieveVolumeInfo()
 {
-    return QByteArray();
+    const QByteArray path = QFile::encodeName(rootPath);
+    QStorageStatisticsCollector::count(QStorageStatistics::StatCalls);
+    QStoragePhaseTimer timer(QStorageStatistics::StatPhase);
+
+    QStorageStatInfo info;
+    bool expired;
+    const bool ok = runQuery(statVolume, path, &info, &expired);
+    QStorageStatisticsCollector::addStatLatency(rootPath, timer.stop());
+    timedOut = expired;
+    if (expired) {
+        // the volume is mounted, it just does not answer
+        valid = true;
+        ready = false;
+    } else if (ok) {
+        valid = true;
+        ready = true;
+        bytesTotal = info.bytesTotal;
+        bytesFree = info.bytesFree;
+        bytesAvailable = info.bytesAvailable;
+        filesTotal = info.filesTotal;
+        filesFree = info.filesFree;
+        filesAvailable = info.filesAvailable;
+        blockSize = info.blockSize;
+        fragmentSize = info.fragmentSize;
+        maximumFileNameLength = info.maximumFileNameLength;
+        mountFlags = info.mountFlags;
+        if (info.readOnly)
+            mountFlags |= QStorageInfo::ReadOnlyMount;
+        readOnly = (mountFlags & QStorageInfo::ReadOnlyMount) != 0;
+    }
 }
 
-#endif
-
-void QStorageInfoPrivate::initRootPath()
+void QStorageInfoPrivate::retrieveIoGeometry()
 {
-    rootPath = QFileInfo(rootPath).canonicalFilePath();
+    // stat() hangs just like statvfs() on a volume whose server is gone, so
+    // it is bounded by the query timeout as well, and not even tried if the
+    // volume did not answer statvfs()
+    if (!timedOut) {
+        QStorageStatInfo info;
+        bool expired;
+        if (runQuery(statPath, QFile::encodeName(rootPath), &info, &expired))
+            ioBlockSize = info.blockSize;
+    }
 
-    if (rootPath.isEmpty())
+#ifdef Q_OS_LINUX
+    // anonymous devices (network filesystems, btrfs, tmpfs) have no queue
+    if (deviceMajor <= 0)
         return;
 
-    QStorageIterator it;
-    if (!it.isValid()) {
-        rootPath = QStringLiteral("/");
-        return;
+    QByteArray directory;
+    if (QStorageBlockDeviceRoot *root = blockDeviceRoot()) {
+        QMutexLocker locker(&root->mutex);
+        directory = root->path;
+    }
+    if (directory.isEmpty())
+        directory = pathBlockDevices;
+    directory += '/' + QByteArray::number(deviceMajor) + ':' + QByteArray::number(deviceMinor);
+
+    // partitions share the queue of the whole disk
+    QByteArray queue = directory + "/queue/";
+    logicalBlockSize = int(readNumberAttribute(queue + "logical_block_size"));
+    if (logicalBlockSize == -1) {
+        queue = directory + "/../queue/";
+        logicalBlockSize = int(readNumberAttribute(queue + "logical_block_size"));
+        if (logicalBlockSize == -1)
+            return;
     }
 
-    int maxLength = 0;
-    const QString oldRootPath = rootPath;
-    rootPath.clear();
+    physicalBlockSize = int(readNumberAttribute(queue + "physical_block_size"));
+    minimumIoSize = int(readNumberAttribute(queue + "minimum_io_size"));
+    optimalIoSize = int(readNumberAttribute(queue + "optimal_io_size"));
+    discardGranularity = readNumberAttribute(queue + "discard_granularity");
+    const qint64 maximumSectorsKb = readNumberAttribute(queue + "max_sectors_kb");
+    maximumTransferSize = maximumSectorsKb == -1 ? -1 : maximumSectorsKb * 1024;
+
+    deviceFlags = 0;
+    if (readNumberAttribute(queue + "rotational") > 0)
+        deviceFlags |= QStorageInfo::RotationalDevice;
+    if (readNumberAttribute(queue + "dax") > 0)
+        deviceFlags |= QStorageInfo::DaxDevice;
+    const QByteArray zoned = readAttribute(queue + "zoned");
+    if (zoned == "host-aware")
+        deviceFlags |= QStorageInfo::HostAwareZonedDevice;
+    else if (zoned == "host-managed")
+        deviceFlags |= QStorageInfo::HostManagedZonedDevice;
+#endif
+}
 
-    while (it.next()) {
-        const QString mountDir = it.rootPath();
-        const QByteArray fsName = it.fileSystemType();
-        if (isPseudoFs(mountDir, fsName))
+QList<QStorageInfo> QStorageInfoPrivate::mountedVolumes()
+{
+    const QStorageMountTable table = mountTable();
+    if (!table.valid)
+        return QList<QStorageInfo>() << root();
+
+    QList<QStorageInfo> volumes;
+
+    for (int i = 0; i < table.entries.size(); ++i) {
+        const QStorageMountEntry &entry = table.entries.at(i);
+        if (entry.pseudo)
             continue;
-        // we try to find most suitable entry
-        if (oldRootPath.startsWith(mountDir) && maxLength < mountDir.length()) {
-            maxLength = mountDir.length();
-            rootPath = mountDir;
-            device = it.device();
-            fileSystemType = fsName;
-        }
+
+        volumes.append(fromMountEntry(entry));
     }
+
+    return volumes;
 }
 
-static inline QString retrieveLabel(const QByteArray &device)
+// Hands out one shared QStorageInfoPrivate per mounted volume, so that all
+// QStorageInfo objects for a volume use (and refresh) the same data. The
+// registry doesn't own the objects; they remove themselves when the last
+// QStorageInfo referring to them is gone.
+class QStorageVolumeRegistry
 {
-#ifdef Q_OS_LINUX
-    static const char pathDiskByLabel[] = "/dev/disk/by-label";
-
-    QDirIterator it(QLatin1String(pathDiskByLabel), QDir::NoDotAndDotDot);
-    while (it.hasNext()) {
-        it.next();
-        QFileInfo fileInfo(it.fileInfo());
-        if (fileInfo.isSymLink() && fileInfo.symLinkTarget().toLocal8Bit() == device)
-            return fileInfo.fileName();
+public:
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> volume(const QStorageMountEntry &entry);
+    void remove(QStorageInfoPrivate *d);
+
+private:
+    QMutex mutex;
+    QHash<QByteArray, QStorageInfoPrivate *> volumes;
+};
+
+Q_GLOBAL_STATIC(QStorageVolumeRegistry, volumeRegistry)
+
+static QByteArray volumeKey(int mountId, const QString &rootPath, const QByteArray &device)
+{
+    QByteArray result = QByteArray::number(mountId);
+    result += '\0';
+    result += QFile::encodeName(rootPath);
+    result += '\0';
+    result += device;
+    return result;
+}
+
+// Takes a reference unless the object is already on its way to destruction.
+static bool tryRef(QStorageInfoPrivate *d)
+{
+    int count = d->ref.load();
+    while (count > 0) {
+        if (d->ref.testAndSetOrdered(count, count + 1))
+            return true;
+        count = d->ref.load();
     }
-#elif defined Q_OS_HAIKU
-    fs_info fsInfo;
-    memset(&fsInfo, 0, sizeof(fsInfo));
+    return false;
+}
 
-    int32 pos = 0;
-    dev_t dev;
-    while ((dev = next_dev(&pos)) >= 0) {
-        if (fs_stat_dev(dev, &fsInfo) != 0)
-            continue;
+QExplicitlySharedDataPointer<QStorageInfoPrivate> QStorageVolumeRegistry::volume(const QStorageMountEntry &entry)
+{
+    const QByteArray key = volumeKey(entry.mountId, entry.rootPath, entry.device);
+
+    // must be released after the lock, its destructor may call remove()
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> existing;
 
-        if (qstrcmp(fsInfo.device_name, device.constData()) == 0)
-            return QString::fromLocal8Bit(fsInfo.volume_name);
+    QMutexLocker locker(&mutex);
+    QStorageInfoPrivate *&d = volumes[key];
+    if (d && tryRef(d)) {
+        existing = QExplicitlySharedDataPointer<QStorageInfoPrivate>(d);
+        d->ref.deref();
+
+        // a refresh may have moved it to another volume in the meantime
+        QMutexLocker volumeLocker(&existing->mutex);
+        if (volumeKey(existing->mountId, existing->rootPath, existing->device) == key)
+            return existing;
     }
-#else
-    Q_UNUSED(device);
-#endif
 
-    return QString();
+    d = new QStorageInfoPrivate;
+    d->setMountEntry(entry);
+    d->registryKey = key;
+    return QExplicitlySharedDataPointer<QStorageInfoPrivate>(d);
 }
 
-void QStorageInfoPrivate::doStat()
+void QStorageVolumeRegistry::remove(QStorageInfoPrivate *d)
 {
-    initRootPath();
-    if (rootPath.isEmpty())
-        return;
-
-    retrieveVolumeInfo();
-    name = retrieveLabel(device);
+    QMutexLocker locker(&mutex);
+    QHash<QByteArray, QStorageInfoPrivate *>::iterator it = volumes.find(d->registryKey);
+    if (it != volumes.end() && it.value() == d)
+        volumes.erase(it);
 }
 
-void QStorageInfoPrivate::retrieveVolumeInfo()
+QExplicitlySharedDataPointer<QStorageInfoPrivate> QStorageInfoPrivate::volumeForEntry(const QStorageMountEntry &entry)
 {
-    QT_STATFSBUF statfs_buf;
-    int result;
-    EINTR_LOOP(result, QT_STATFS(QFile::encodeName(rootPath).constData(), &statfs_buf));
-    if (result == 0) {
-        valid = true;
-        ready = true;
+    if (QStorageVolumeRegistry *registry = volumeRegistry())
+        return registry->volume(entry);
 
-        bytesTotal = statfs_buf.f_blocks * statfs_buf.f_bsize;
-        bytesFree = statfs_buf.f_bfree * statfs_buf.f_bsize;
-        bytesAvailable = statfs_buf.f_bavail * statfs_buf.f_bsize;
-#if defined(Q_OS_ANDROID) || defined (Q_OS_BSD4)
-#if defined(_STATFS_F_FLAGS)
-        readOnly = (statfs_buf.f_flags & ST_RDONLY) != 0;
-#endif
-#else
-        readOnly = (statfs_buf.f_flag & ST_RDONLY) != 0;
-#endif
-    }
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> d(new QStorageInfoPrivate);
+    d->setMountEntry(entry);
+    return d;
 }
 
-QList<QStorageInfo> QStorageInfoPrivate::mountedVolumes()
+QExplicitlySharedDataPointer<QStorageInfoPrivate> QStorageInfoPrivate::volumeForPath(const QString &path)
 {
-    QStorageIterator it;
-    if (!it.isValid())
-        return QList<QStorageInfo>() << root();
+    QStoragePhaseTimer timer(QStorageStatistics::CanonicalPathPhase);
+    const QString canonicalPath = QFileInfo(path).canonicalFilePath();
+    timer.stop();
+    if (!canonicalPath.isEmpty()) {
+        const QStorageMountTable table = mountTable();
+        const int index = table.valid ? table.findVolume(canonicalPath) : -1;
+        if (index != -1) {
+            const QStorageMountEntry &entry = table.entries.at(index);
+
+            // Only the mount table is consulted here; dropping the space
+            // information makes the next access query the volume again. The
+            // label and the I/O geometry of a mounted volume do not change
+            // on their own, so they stay shared until refresh().
+            QExplicitlySharedDataPointer<QStorageInfoPrivate> d = volumeForEntry(entry);
+            QMutexLocker locker(&d->mutex);
+            d->setMountEntry(entry);
+            d->fetched &= ~QStorageInfoPrivate::VolumeInfoField;
+            return d;
+        }
+    }
 
-    QList<QStorageInfo> volumes;
+    // paths that are not on any known volume are not shared
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> d(new QStorageInfoPrivate);
+    d->rootPath = path;
+    d->doStat();
+    return d;
+}
 
-    while (it.next()) {
-        const QString mountDir = it.rootPath();
-        const QByteArray fsName = it.fileSystemType();
-        if (isPseudoFs(mountDir, fsName))
-            continue;
+void QStorageInfoPrivate::unregisterVolume()
+{
+    if (QStorageVolumeRegistry *registry = volumeRegistry())
+        registry->remove(this);
+}
 
-        volumes.append(QStorageInfo(mountDir));
+QStorageInfo QStorageInfoPrivate::fromMountEntry(const QStorageMountEntry &entry, bool retrieveInfo)
+{
+    // The mount table already knows the mount point, the device and the
+    // filesystem type; going through QStorageInfo(rootPath) would look the
+    // entry up again.
+    QExplicitlySharedDataPointer<QStorageInfoPrivate> d = volumeForEntry(entry);
+    if (retrieveInfo) {
+        QStorageInfoPrivate fresh;
+        fresh.setMountEntry(entry);
+        fresh.retrieveVolumeInfo();
+        fresh.retrieveLabel();
+        // the I/O geometry is rarely needed and stays lazy
+        fresh.fetched = VolumeInfoField | LabelField;
+
+        QMutexLocker locker(&d->mutex);
+        d->assign(fresh);
     }
+    return QStorageInfo(*d);
+}
 
-    return volumes;
+void QStorageInfoPrivate::invalidate(const QStorageInfo &info)
+{
+    QMutexLocker locker(&info.d->mutex);
+    info.d->fetched = 0;
 }
 
 QStorageInfo QStorageInfoPrivate::root()
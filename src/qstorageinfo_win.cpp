@@ -119,6 +119,11 @@ void QStorageInfoPrivate::doStat()
     retrieveDiskFreeSpace();
 }
 
+void QStorageInfoPrivate::doStatSpace()
+{
+    retrieveDiskFreeSpace();
+}
+
 void QStorageInfoPrivate::retrieveVolumeInfo()
 {
     const UINT oldmode = ::SetErrorMode(SEM_FAILCRITICALERRORS | SEM_NOOPENFILEERRORBOX);
@@ -126,12 +131,13 @@ void QStorageInfoPrivate::retrieveVolumeInfo()
     const QString path = QDir::toNativeSeparators(rootPath);
     wchar_t nameBuffer[defaultBufferSize];
     wchar_t fileSystemTypeBuffer[defaultBufferSize];
+    DWORD maximumComponentLength = 0;
     DWORD fileSystemFlags = 0;
     const bool result = ::GetVolumeInformation(reinterpret_cast<const wchar_t *>(path.utf16()),
                                                nameBuffer,
                                                defaultBufferSize,
                                                Q_NULLPTR,
-                                               Q_NULLPTR,
+                                               &maximumComponentLength,
                                                &fileSystemFlags,
                                                fileSystemTypeBuffer,
                                                defaultBufferSize);
@@ -139,7 +145,10 @@ void QStorageInfoPrivate::retrieveVolumeInfo()
         fileSystemType = QString::fromWCharArray(fileSystemTypeBuffer).toLatin1();
         name = QString::fromWCharArray(nameBuffer);
 
+        maximumFileNameLength = int(maximumComponentLength);
+
         readOnly = (fileSystemFlags & FILE_READ_ONLY_VOLUME) != 0;
+        mountFlags = readOnly ? uint(QStorageInfo::ReadOnlyMount) : 0;
     }
 
     ::SetErrorMode(oldmode);
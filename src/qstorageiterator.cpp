@@ -0,0 +1,213 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qstorageiterator_p.h"
+#include "qstoragestatistics_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QStorageIterator
+    \inmodule QtCore
+    \brief Provides a lightweight way to walk the table of mounted filesystems.
+
+    \ingroup io
+
+    QStorageIterator reads the mount table of the system once, when it is
+    constructed, and lets you step through its entries with next(). Unlike
+    QStorageInfo::mountedVolumes(), it neither queries the volumes nor
+    allocates anything per entry: the accessors return '\\0'-terminated
+    strings that point into the buffer of the iterator, which makes it cheap
+    to count or filter the mounts.
+
+    \code
+    QStorageIterator it;
+    while (it.next()) {
+        if (qstrcmp(it.fileSystemType(), "ext4") == 0)
+            qDebug() << QFile::decodeName(it.rootPath());
+    }
+    \endcode
+
+    The returned strings are only valid until the next call to next() or
+    until the iterator is destroyed; copy them if they need to live longer.
+    They are returned as they are stored by the system, without any
+    conversion; use QFile::decodeName() to convert paths to a QString.
+
+    The iterator is not available on Windows, where isValid() always returns
+    false.
+
+    \sa QStorageInfo::mountedVolumes()
+*/
+
+/*!
+    Constructs a QStorageIterator and reads the current mount table.
+*/
+QStorageIterator::QStorageIterator()
+    : d(new QStorageIteratorPrivate)
+{
+}
+
+/*!
+    Destroys the QStorageIterator and frees the mount table.
+*/
+QStorageIterator::~QStorageIterator()
+{
+    delete d;
+}
+
+/*!
+    Returns true if the mount table could be read; otherwise returns false.
+*/
+bool QStorageIterator::isValid() const
+{
+    return d->isValid();
+}
+
+/*!
+    Advances the iterator to the next mounted filesystem and returns true if
+    there was one; otherwise returns false.
+
+    The iterator is positioned before the first entry after construction, so
+    next() has to be called before accessing the first one.
+*/
+bool QStorageIterator::next()
+{
+    if (!d->next())
+        return false;
+    QStorageStatisticsCollector::count(QStorageStatistics::MountEntriesParsed);
+    return true;
+}
+
+/*!
+    Returns the mount point of the current entry, as stored by the system;
+    use QFile::decodeName() to convert it to a QString.
+*/
+const char *QStorageIterator::rootPath() const
+{
+    return d->rootPath();
+}
+
+/*!
+    Returns the device of the current entry, usually the special file
+    backing the filesystem.
+*/
+const char *QStorageIterator::device() const
+{
+    return d->device();
+}
+
+/*!
+    Returns the type of the filesystem of the current entry.
+*/
+const char *QStorageIterator::fileSystemType() const
+{
+    return d->fileSystemType();
+}
+
+/*!
+    Returns the comma separated mount options of the current entry.
+
+    On Linux these are the per mount options only, the options of the
+    filesystem itself are returned by superOptions(). On BSD systems this is
+    the decimal value of the mount flags.
+*/
+const char *QStorageIterator::options() const
+{
+    return d->options();
+}
+
+/*!
+    Returns the options of the filesystem (superblock) of the current entry,
+    or an empty string if they are not known separately from options().
+*/
+const char *QStorageIterator::superOptions() const
+{
+    return d->superOptions();
+}
+
+/*!
+    Returns the path of the directory of the filesystem that is mounted on
+    the mount point, which differs from "/" for bind mounts, or an empty
+    string if it is unknown. Like rootPath(), it is not converted from the
+    encoding of the system.
+*/
+const char *QStorageIterator::fileSystemRoot() const
+{
+    return d->fileSystemRoot();
+}
+
+/*!
+    Returns the space separated optional fields (like "shared:1") of the
+    current entry of /proc/self/mountinfo, or an empty string.
+*/
+const char *QStorageIterator::optionalFields() const
+{
+    return d->optionalFields();
+}
+
+/*!
+    Returns the unique id of the current mount, or -1 if it is unknown.
+*/
+int QStorageIterator::mountId() const
+{
+    return d->mountId();
+}
+
+/*!
+    Returns the id of the parent mount of the current one, or -1 if it is
+    unknown.
+*/
+int QStorageIterator::parentMountId() const
+{
+    return d->parentMountId();
+}
+
+/*!
+    Returns the major number of the device of the current entry, or -1 if it
+    is unknown.
+*/
+int QStorageIterator::majorDeviceNumber() const
+{
+    return d->majorDeviceNumber();
+}
+
+/*!
+    Returns the minor number of the device of the current entry, or -1 if it
+    is unknown.
+*/
+int QStorageIterator::minorDeviceNumber() const
+{
+    return d->minorDeviceNumber();
+}
+
+QT_END_NAMESPACE
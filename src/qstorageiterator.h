@@ -0,0 +1,72 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSTORAGEITERATOR_H
+#define QSTORAGEITERATOR_H
+
+#include <QtCore/qglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+class QStorageIteratorPrivate;
+class QSTORAGEINFO_EXPORT QStorageIterator
+{
+public:
+    QStorageIterator();
+    ~QStorageIterator();
+
+    bool isValid() const;
+    bool next();
+
+    const char *rootPath() const;
+    const char *device() const;
+    const char *fileSystemType() const;
+    const char *options() const;
+    const char *superOptions() const;
+    const char *fileSystemRoot() const;
+    const char *optionalFields() const;
+
+    int mountId() const;
+    int parentMountId() const;
+    int majorDeviceNumber() const;
+    int minorDeviceNumber() const;
+
+private:
+    Q_DISABLE_COPY(QStorageIterator)
+
+    QStorageIteratorPrivate *d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSTORAGEITERATOR_H
@@ -0,0 +1,154 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSTORAGEITERATOR_P_H
+#define QSTORAGEITERATOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qstorageiterator.h"
+
+#include <QtCore/qbytearray.h>
+
+#if defined(Q_OS_BSD4)
+#  include <sys/mount.h>
+#  include <sys/statvfs.h>
+#elif defined(Q_OS_SOLARIS)
+#  include <stdio.h>
+#  include <sys/mnttab.h>
+#elif defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#  include <mntent.h>
+#  include <stdio.h>
+#elif defined(Q_OS_HAIKU)
+#  include <VolumeRoster.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+class QStorageIteratorPrivate
+{
+public:
+    QStorageIteratorPrivate();
+    ~QStorageIteratorPrivate();
+
+    bool isValid() const;
+    bool next();
+
+    // all fields are NUL terminated and stay valid until the next call to next()
+    const char *rootPath() const;
+    const char *device() const;
+    const char *fileSystemType() const;
+    const char *options() const;
+    const char *superOptions() const;
+    const char *fileSystemRoot() const;
+    const char *optionalFields() const;
+
+    int mountId() const;
+    int parentMountId() const;
+    int majorDeviceNumber() const;
+    int minorDeviceNumber() const;
+
+private:
+#if defined(Q_OS_BSD4)
+#  if defined(Q_OS_NETBSD)
+    struct statvfs *stat_buf;
+#  else
+    struct statfs *stat_buf;
+#  endif
+    int entryCount;
+    int currentIndex;
+    char flags[24];
+#elif defined(Q_OS_SOLARIS)
+    FILE *fp;
+    mnttab mnt;
+#elif defined(Q_OS_LINUX)
+    bool readTable(const char *fileName);
+    bool readOverride();
+    bool parseMountInfo(char *line);
+    bool parseMounts(char *line);
+
+    // the whole of /proc/self/mountinfo (or /proc/mounts on Android), split in place
+    QByteArray buffer;
+    bool bufferValid;
+    int position;
+    int m_mountId;
+    int m_parentMountId;
+    int m_deviceMajor;
+    int m_deviceMinor;
+    const char *m_fileSystemRoot;
+    const char *m_rootPath;
+    const char *m_options;
+    const char *m_optionalFields;
+    const char *m_fileSystemType;
+    const char *m_device;
+    const char *m_superOptions;
+
+#  if !defined(Q_OS_ANDROID)
+    // /etc/mtab fallback
+    FILE *fp;
+    mntent mnt;
+#  endif
+#elif defined(Q_OS_HAIKU)
+    BVolumeRoster m_volumeRoster;
+
+    QByteArray m_rootPath;
+    QByteArray m_fileSystemType;
+    QByteArray m_device;
+#endif
+};
+
+#if defined(Q_OS_LINUX)
+// For tests and benchmarks: make QStorageIterator, and with it QStorageInfo,
+// read the mount table from another file or from memory, in the format of
+// /proc/self/mountinfo or /etc/mtab.
+QSTORAGEINFO_EXPORT void qt_storage_setMountTableFile(const QString &fileName);
+QSTORAGEINFO_EXPORT void qt_storage_setMountTableData(const QByteArray &data);
+QSTORAGEINFO_EXPORT void qt_storage_resetMountTable();
+
+// Changes whenever one of the functions above is called.
+int qt_storage_mountTableSerial();
+bool qt_storage_hasMountTableOverride();
+#endif
+
+QT_END_NAMESPACE
+
+#endif // QSTORAGEITERATOR_P_H
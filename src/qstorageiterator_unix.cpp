@@ -0,0 +1,665 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qstorageiterator_p.h"
+#include "qstoragestatistics_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmutex.h>
+
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(Q_OS_HAIKU)
+#  include <Directory.h>
+#  include <Path.h>
+#  include <Volume.h>
+#  include <fs_info.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#if defined(Q_OS_BSD4)
+
+QStorageIteratorPrivate::QStorageIteratorPrivate()
+    : entryCount(::getmntinfo(&stat_buf, 0)),
+      currentIndex(-1)
+{
+    flags[0] = '\0';
+}
+
+QStorageIteratorPrivate::~QStorageIteratorPrivate()
+{
+}
+
+bool QStorageIteratorPrivate::isValid() const
+{
+    return entryCount != -1;
+}
+
+bool QStorageIteratorPrivate::next()
+{
+    if (++currentIndex >= entryCount)
+        return false;
+    qsnprintf(flags, sizeof(flags), "%llu", qulonglong(stat_buf[currentIndex].f_flags));
+    return true;
+}
+
+const char *QStorageIteratorPrivate::rootPath() const
+{
+    return stat_buf[currentIndex].f_mntonname;
+}
+
+const char *QStorageIteratorPrivate::device() const
+{
+    return stat_buf[currentIndex].f_mntfromname;
+}
+
+const char *QStorageIteratorPrivate::fileSystemType() const
+{
+    return stat_buf[currentIndex].f_fstypename;
+}
+
+const char *QStorageIteratorPrivate::options() const
+{
+    return flags;
+}
+
+#elif defined(Q_OS_SOLARIS)
+
+static const char pathMounted[] = "/etc/mnttab";
+
+QStorageIteratorPrivate::QStorageIteratorPrivate()
+{
+    const int fd = qt_safe_open(pathMounted, O_RDONLY);
+    fp = ::fdopen(fd, "r");
+    QStorageStatisticsCollector::count(QStorageStatistics::FilesOpened);
+}
+
+QStorageIteratorPrivate::~QStorageIteratorPrivate()
+{
+    if (fp)
+        ::fclose(fp);
+}
+
+bool QStorageIteratorPrivate::isValid() const
+{
+    return fp != Q_NULLPTR;
+}
+
+bool QStorageIteratorPrivate::next()
+{
+    return ::getmntent(fp, &mnt) == 0;
+}
+
+const char *QStorageIteratorPrivate::rootPath() const
+{
+    return mnt.mnt_mountp;
+}
+
+const char *QStorageIteratorPrivate::device() const
+{
+    return mnt.mnt_special;
+}
+
+const char *QStorageIteratorPrivate::fileSystemType() const
+{
+    return mnt.mnt_fstype;
+}
+
+const char *QStorageIteratorPrivate::options() const
+{
+    return mnt.mnt_mntopts;
+}
+
+#elif defined(Q_OS_LINUX)
+
+#if defined(Q_OS_ANDROID)
+static const char pathMounts[] = "/proc/mounts";
+#else
+static const char pathMountInfo[] = "/proc/self/mountinfo";
+static const char pathMounted[] = "/etc/mtab";
+#endif
+static const int bufferSize = 3*PATH_MAX; // 2 paths (mount point+device) and metainfo
+
+// Size of the last table that was read; files in /proc don't know their size
+// up front, so we start from it to read the whole table with a single read().
+static QBasicAtomicInt tableSizeHint = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static bool readAll(int fd, QByteArray *buffer)
+{
+    int size = 0;
+    buffer->resize(tableSizeHint.load() + bufferSize);
+    for (;;) {
+        if (buffer->size() - size < bufferSize)
+            buffer->resize(2 * buffer->size());
+        const qint64 count = qt_safe_read(fd, buffer->data() + size, buffer->size() - size);
+        if (count < 0)
+            return false;
+        if (count == 0)
+            break;
+        size += int(count);
+    }
+    buffer->resize(size);
+    tableSizeHint.store(size);
+    return true;
+}
+
+struct QStorageMountTableOverride
+{
+    inline QStorageMountTableOverride() : active(false) {}
+
+    QMutex mutex;
+    QString fileName;
+    QByteArray data;
+    bool active;
+};
+
+Q_GLOBAL_STATIC(QStorageMountTableOverride, mountTableOverride)
+
+static QBasicAtomicInt mountTableSerial = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInt mountTableOverridden = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static void setMountTableOverride(bool active, const QString &fileName, const QByteArray &data)
+{
+    if (QStorageMountTableOverride *source = mountTableOverride()) {
+        QMutexLocker locker(&source->mutex);
+        source->active = active;
+        source->fileName = fileName;
+        source->data = data;
+        mountTableOverridden.store(active);
+        mountTableSerial.ref();
+    }
+}
+
+void qt_storage_setMountTableFile(const QString &fileName)
+{
+    setMountTableOverride(true, fileName, QByteArray());
+}
+
+void qt_storage_setMountTableData(const QByteArray &data)
+{
+    setMountTableOverride(true, QString(), data);
+}
+
+void qt_storage_resetMountTable()
+{
+    setMountTableOverride(false, QString(), QByteArray());
+}
+
+int qt_storage_mountTableSerial()
+{
+    return mountTableSerial.load();
+}
+
+bool qt_storage_hasMountTableOverride()
+{
+    return mountTableOverridden.load();
+}
+
+// Splits the next space separated field off \a cursor, in place.
+static char *nextField(char **cursor)
+{
+    char *field = *cursor;
+    if (!field)
+        return Q_NULLPTR;
+    char *space = strchr(field, ' ');
+    if (space) {
+        *space = '\0';
+        *cursor = space + 1;
+    } else {
+        *cursor = Q_NULLPTR;
+    }
+    return field;
+}
+
+static inline bool isOctalDigit(char c)
+{
+    return c >= '0' && c <= '7';
+}
+
+// Decodes the \ooo escapes the kernel uses for blanks and backslashes, in place.
+static char *unescapeField(char *field)
+{
+    char *out = field;
+    for (const char *in = field; *in; ++in, ++out) {
+        if (in[0] == '\\' && isOctalDigit(in[1]) && isOctalDigit(in[2]) && isOctalDigit(in[3])) {
+            *out = char(((in[1] - '0') << 6) | ((in[2] - '0') << 3) | (in[3] - '0'));
+            in += 3;
+        } else {
+            *out = *in;
+        }
+    }
+    *out = '\0';
+    return field;
+}
+
+QStorageIteratorPrivate::QStorageIteratorPrivate() :
+    bufferValid(false),
+    position(0),
+    m_mountId(-1),
+    m_parentMountId(-1),
+    m_deviceMajor(-1),
+    m_deviceMinor(-1),
+    m_fileSystemRoot(""),
+    m_rootPath(""),
+    m_options(""),
+    m_optionalFields(""),
+    m_fileSystemType(""),
+    m_device(""),
+    m_superOptions("")
+#if !defined(Q_OS_ANDROID)
+    , fp(Q_NULLPTR)
+#endif
+{
+    if (readOverride())
+        return;
+
+#if defined(Q_OS_ANDROID)
+    bufferValid = readTable(pathMounts);
+#else
+    bufferValid = readTable(pathMountInfo);
+    if (bufferValid)
+        return;
+
+    buffer = QByteArray(bufferSize, 0);
+    fp = ::setmntent(pathMounted, "r");
+    QStorageStatisticsCollector::count(QStorageStatistics::FilesOpened);
+#endif
+}
+
+QStorageIteratorPrivate::~QStorageIteratorPrivate()
+{
+#if !defined(Q_OS_ANDROID)
+    if (fp)
+        ::endmntent(fp);
+#endif
+}
+
+bool QStorageIteratorPrivate::readTable(const char *fileName)
+{
+    const int fd = qt_safe_open(fileName, O_RDONLY);
+    QStorageStatisticsCollector::count(QStorageStatistics::FilesOpened);
+    if (fd == -1)
+        return false;
+    const bool ok = readAll(fd, &buffer);
+    qt_safe_close(fd);
+    return ok;
+}
+
+bool QStorageIteratorPrivate::readOverride()
+{
+    if (!mountTableOverridden.load())
+        return false;
+
+    QStorageMountTableOverride *source = mountTableOverride();
+    if (!source)
+        return false;
+
+    QMutexLocker locker(&source->mutex);
+    if (!source->active)
+        return false;
+
+    if (source->fileName.isEmpty()) {
+        buffer = source->data;
+        buffer.detach(); // it is split in place
+        bufferValid = true;
+    } else {
+        bufferValid = readTable(QFile::encodeName(source->fileName).constData());
+    }
+    return true;
+}
+
+bool QStorageIteratorPrivate::isValid() const
+{
+#if defined(Q_OS_ANDROID)
+    return bufferValid;
+#else
+    return bufferValid || fp != Q_NULLPTR;
+#endif
+}
+
+// A line looks like
+// 36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+// with any number of optional fields (master:1) before the separator.
+bool QStorageIteratorPrivate::parseMountInfo(char *line)
+{
+    char *cursor = line;
+    const char *mountId = nextField(&cursor);
+    const char *parentMountId = nextField(&cursor);
+    const char *deviceNumber = nextField(&cursor);
+    char *fileSystemRoot = nextField(&cursor);
+    char *rootPath = nextField(&cursor);
+    const char *options = nextField(&cursor);
+    if (!cursor)
+        return false;
+
+    const char *optionalFields = "";
+    if (qstrncmp(cursor, "- ", 2) == 0) {
+        cursor += 2;
+    } else {
+        char *separator = strstr(cursor, " - ");
+        if (!separator)
+            return false;
+        *separator = '\0';
+        optionalFields = cursor;
+        cursor = separator + 3;
+    }
+
+    const char *fileSystemType = nextField(&cursor);
+    char *device = nextField(&cursor);
+    const char *superOptions = nextField(&cursor);
+    if (!superOptions)
+        return false;
+
+    const char *minor = strchr(deviceNumber, ':');
+    if (!minor)
+        return false;
+
+    m_mountId = int(strtol(mountId, Q_NULLPTR, 10));
+    m_parentMountId = int(strtol(parentMountId, Q_NULLPTR, 10));
+    m_deviceMajor = int(strtol(deviceNumber, Q_NULLPTR, 10));
+    m_deviceMinor = int(strtol(minor + 1, Q_NULLPTR, 10));
+    m_fileSystemRoot = unescapeField(fileSystemRoot);
+    m_rootPath = unescapeField(rootPath);
+    m_options = options;
+    m_optionalFields = optionalFields;
+    m_fileSystemType = fileSystemType;
+    m_device = unescapeField(device);
+    m_superOptions = superOptions;
+    return true;
+}
+
+static inline bool isMountInfoLine(const char *line)
+{
+    return line[0] >= '0' && line[0] <= '9' && strstr(line, " - ") != Q_NULLPTR;
+}
+
+// A line looks like
+// /dev/block/mmcblk0p9 /system ext4 ro,seclabel,relatime 0 0
+bool QStorageIteratorPrivate::parseMounts(char *line)
+{
+    char *cursor = line;
+    char *device = nextField(&cursor);
+    char *rootPath = nextField(&cursor);
+    const char *fileSystemType = nextField(&cursor);
+    const char *options = nextField(&cursor);
+    if (!fileSystemType)
+        return false;
+
+    m_mountId = -1;
+    m_parentMountId = -1;
+    m_deviceMajor = -1;
+    m_deviceMinor = -1;
+    m_fileSystemRoot = "";
+    m_device = unescapeField(device);
+    m_rootPath = unescapeField(rootPath);
+    m_fileSystemType = fileSystemType;
+    m_options = options ? options : "";
+    m_optionalFields = "";
+    m_superOptions = "";
+    return true;
+}
+
+bool QStorageIteratorPrivate::next()
+{
+#if !defined(Q_OS_ANDROID)
+    if (!bufferValid) {
+        if (!::getmntent_r(fp, &mnt, buffer.data(), buffer.size()))
+            return false;
+        m_rootPath = mnt.mnt_dir;
+        m_fileSystemType = mnt.mnt_type;
+        m_device = mnt.mnt_fsname;
+        m_options = mnt.mnt_opts;
+        return true;
+    }
+#endif
+
+    while (position < buffer.size()) {
+        char *line = buffer.data() + position;
+        char *end = static_cast<char *>(memchr(line, '\n', buffer.size() - position));
+        if (!end)
+            end = buffer.data() + buffer.size();
+        *end = '\0';
+        position = int(end - buffer.constData()) + 1;
+        // the system table has a fixed format, but one set for testing may
+        // be in either
+        if (isMountInfoLine(line) ? parseMountInfo(line) : parseMounts(line))
+            return true;
+    }
+    return false;
+}
+
+const char *QStorageIteratorPrivate::rootPath() const
+{
+    return m_rootPath;
+}
+
+const char *QStorageIteratorPrivate::device() const
+{
+    return m_device;
+}
+
+const char *QStorageIteratorPrivate::fileSystemType() const
+{
+    return m_fileSystemType;
+}
+
+const char *QStorageIteratorPrivate::options() const
+{
+    return m_options;
+}
+
+const char *QStorageIteratorPrivate::superOptions() const
+{
+    return m_superOptions;
+}
+
+const char *QStorageIteratorPrivate::fileSystemRoot() const
+{
+    return m_fileSystemRoot;
+}
+
+const char *QStorageIteratorPrivate::optionalFields() const
+{
+    return m_optionalFields;
+}
+
+int QStorageIteratorPrivate::mountId() const
+{
+    return m_mountId;
+}
+
+int QStorageIteratorPrivate::parentMountId() const
+{
+    return m_parentMountId;
+}
+
+int QStorageIteratorPrivate::majorDeviceNumber() const
+{
+    return m_deviceMajor;
+}
+
+int QStorageIteratorPrivate::minorDeviceNumber() const
+{
+    return m_deviceMinor;
+}
+
+#elif defined(Q_OS_HAIKU)
+
+QStorageIteratorPrivate::QStorageIteratorPrivate()
+{
+}
+
+QStorageIteratorPrivate::~QStorageIteratorPrivate()
+{
+}
+
+bool QStorageIteratorPrivate::isValid() const
+{
+    return true;
+}
+
+bool QStorageIteratorPrivate::next()
+{
+    BVolume volume;
+
+    if (m_volumeRoster.GetNextVolume(&volume) != B_OK)
+        return false;
+
+    BDirectory directory;
+    if (volume.GetRootDirectory(&directory) != B_OK)
+        return false;
+
+    const BPath path(&directory);
+
+    fs_info fsInfo;
+    memset(&fsInfo, 0, sizeof(fsInfo));
+
+    if (fs_stat_dev(volume.Device(), &fsInfo) != 0)
+        return false;
+
+    m_rootPath = path.Path();
+    m_fileSystemType = QByteArray(fsInfo.fsh_name);
+
+    const QByteArray deviceName(fsInfo.device_name);
+    m_device = (deviceName.isEmpty() ? QByteArray::number(qint32(volume.Device())) : deviceName);
+
+    return true;
+}
+
+const char *QStorageIteratorPrivate::rootPath() const
+{
+    return m_rootPath.constData();
+}
+
+const char *QStorageIteratorPrivate::device() const
+{
+    return m_device.constData();
+}
+
+const char *QStorageIteratorPrivate::fileSystemType() const
+{
+    return m_fileSystemType.constData();
+}
+
+const char *QStorageIteratorPrivate::options() const
+{
+    return "";
+}
+
+#else
+
+QStorageIteratorPrivate::QStorageIteratorPrivate()
+{
+}
+
+QStorageIteratorPrivate::~QStorageIteratorPrivate()
+{
+}
+
+bool QStorageIteratorPrivate::isValid() const
+{
+    return false;
+}
+
+bool QStorageIteratorPrivate::next()
+{
+    return false;
+}
+
+const char *QStorageIteratorPrivate::rootPath() const
+{
+    return "";
+}
+
+const char *QStorageIteratorPrivate::device() const
+{
+    return "";
+}
+
+const char *QStorageIteratorPrivate::fileSystemType() const
+{
+    return "";
+}
+
+const char *QStorageIteratorPrivate::options() const
+{
+    return "";
+}
+
+#endif
+
+#if !defined(Q_OS_LINUX)
+const char *QStorageIteratorPrivate::superOptions() const
+{
+    return "";
+}
+
+const char *QStorageIteratorPrivate::fileSystemRoot() const
+{
+    return "";
+}
+
+const char *QStorageIteratorPrivate::optionalFields() const
+{
+    return "";
+}
+
+int QStorageIteratorPrivate::mountId() const
+{
+    return -1;
+}
+
+int QStorageIteratorPrivate::parentMountId() const
+{
+    return -1;
+}
+
+int QStorageIteratorPrivate::majorDeviceNumber() const
+{
+    return -1;
+}
+
+int QStorageIteratorPrivate::minorDeviceNumber() const
+{
+    return -1;
+}
+#endif // !Q_OS_LINUX
+
+QT_END_NAMESPACE
@@ -0,0 +1,333 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qstoragesnapshot.h"
+#include "qstorageinfo_p.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class QStorageSnapshotPrivate : public QSharedData
+{
+public:
+    struct Volume
+    {
+        QStorageInfo info;
+        QByteArray key;       // what identifies the mount across snapshots
+        QByteArray signature; // what has to stay the same for it to be unchanged
+        qint64 bytesTotal;
+        qint64 bytesFree;
+        qint64 bytesAvailable;
+    };
+
+    void append(const QStorageInfo &info, const QByteArray &key, const QByteArray &signature,
+                bool retrieveInfo);
+
+    QVector<Volume> volumes;
+    QHash<QByteArray, int> index;
+};
+
+static QByteArray snapshotKey(int mountId, const QString &rootPath, const QByteArray &device)
+{
+    // Mount IDs are unique while the mount exists, even if it is moved;
+    // without them the mount point has to serve.
+    QByteArray result = mountId != -1 ? QByteArray::number(mountId) : QFile::encodeName(rootPath);
+    result += '\0';
+    result += device;
+    return result;
+}
+
+static QByteArray snapshotSignature(const QString &rootPath, const QByteArray &fileSystemType,
+                                    const QByteArray &options)
+{
+    QByteArray result = QFile::encodeName(rootPath);
+    result += '\0';
+    result += fileSystemType;
+    result += '\0';
+    result += options;
+    return result;
+}
+
+void QStorageSnapshotPrivate::append(const QStorageInfo &info, const QByteArray &key,
+                                     const QByteArray &signature, bool retrieveInfo)
+{
+    Volume volume;
+    volume.info = info;
+    volume.key = key;
+    volume.signature = signature;
+    // the space is only compared if it was queried, asking for it here
+    // would query the volume after all
+    volume.bytesTotal = retrieveInfo ? info.bytesTotal() : -1;
+    volume.bytesFree = retrieveInfo ? info.bytesFree() : -1;
+    volume.bytesAvailable = retrieveInfo ? info.bytesAvailable() : -1;
+
+    // keys only repeat if one device is mounted twice on the same mount
+    // point; the earlier mount is then reported as replaced by the later one
+    index.insert(key, volumes.size());
+    volumes.append(volume);
+}
+
+/*!
+    \class QStorageSnapshot
+    \inmodule QtCore
+    \brief Holds the mounted volumes at one point in time and tells what
+    changed since another snapshot.
+
+    \ingroup io
+    \ingroup shared
+
+    A consumer that keeps a list of volumes, like a model, does not have to
+    rebuild it from QStorageInfo::mountedVolumes() on every refresh. Instead
+    it keeps the snapshot the list was built from, takes a new one with
+    current() and applies only the differences that diff() reports:
+
+    \code
+    const QStorageSnapshot snapshot = QStorageSnapshot::current();
+    const QStorageSnapshot::Diff diff = snapshot.diff(m_snapshot);
+    foreach (const QStorageInfo &volume, diff.removed)
+        removeVolume(volume);
+    foreach (const QStorageInfo &volume, diff.added)
+        addVolume(volume);
+    foreach (const QStorageInfo &volume, diff.changed)
+        updateVolume(volume);
+    m_snapshot = snapshot;
+    \endcode
+
+    Volumes are matched by their mount ID and device on Linux, and by their
+    mount point and device elsewhere. Comparing two snapshots takes time
+    linear in the number of volumes.
+
+    \sa QStorageInfo::mountedVolumes(), QStorageWatcher
+*/
+
+/*!
+    \class QStorageSnapshot::Diff
+    \inmodule QtCore
+    \brief Lists the volumes that differ between two snapshots.
+
+    All lists are in the order of the snapshot they are taken from.
+
+    \sa QStorageSnapshot::diff()
+*/
+
+/*!
+    \variable QStorageSnapshot::Diff::added
+
+    The volumes that are only in the newer snapshot.
+*/
+
+/*!
+    \variable QStorageSnapshot::Diff::removed
+
+    The volumes that are only in the older snapshot.
+*/
+
+/*!
+    \variable QStorageSnapshot::Diff::changed
+
+    The volumes of the newer snapshot that are in both, but were remounted
+    with other options, moved to another mount point, or whose space
+    changed.
+*/
+
+/*!
+    \fn bool QStorageSnapshot::Diff::isEmpty() const
+
+    Returns true if no volume was added, removed or changed; otherwise
+    returns false.
+*/
+
+/*!
+    Constructs an empty snapshot. Comparing a snapshot with an empty one
+    reports all of its volumes as added.
+*/
+QStorageSnapshot::QStorageSnapshot()
+    : d(new QStorageSnapshotPrivate)
+{
+}
+
+/*!
+    Constructs a copy of the \a other snapshot.
+*/
+QStorageSnapshot::QStorageSnapshot(const QStorageSnapshot &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Destroys the snapshot.
+*/
+QStorageSnapshot::~QStorageSnapshot()
+{
+}
+
+/*!
+    Makes this snapshot a copy of the \a other one and returns a reference
+    to it.
+*/
+QStorageSnapshot &QStorageSnapshot::operator=(const QStorageSnapshot &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn void QStorageSnapshot::swap(QStorageSnapshot &other)
+
+    Swaps this snapshot with the \a other one. This function is very fast and
+    never fails.
+*/
+
+/*!
+    Returns true if the snapshot holds no volumes; otherwise returns false.
+*/
+bool QStorageSnapshot::isEmpty() const
+{
+    return d->volumes.isEmpty();
+}
+
+/*!
+    Returns the number of volumes in the snapshot.
+*/
+int QStorageSnapshot::size() const
+{
+    return d->volumes.size();
+}
+
+/*!
+    Returns the volumes of the snapshot, in the order of the mount table.
+*/
+QList<QStorageInfo> QStorageSnapshot::volumes() const
+{
+    QList<QStorageInfo> result;
+    result.reserve(d->volumes.size());
+    for (int i = 0; i < d->volumes.size(); ++i)
+        result.append(d->volumes.at(i).info);
+    return result;
+}
+
+/*!
+    Returns the volumes that were added, removed or changed since the
+    \a previous snapshot was taken.
+
+    The space of a volume is only compared if both snapshots queried it,
+    that is, if neither was taken with QStorageInfo::SkipVolumeInfo.
+*/
+QStorageSnapshot::Diff QStorageSnapshot::diff(const QStorageSnapshot &previous) const
+{
+    Diff result;
+    if (d == previous.d)
+        return result;
+
+    const QVector<QStorageSnapshotPrivate::Volume> &oldVolumes = previous.d->volumes;
+    QVector<bool> matched(oldVolumes.size(), false);
+
+    for (int i = 0; i < d->volumes.size(); ++i) {
+        const QStorageSnapshotPrivate::Volume &volume = d->volumes.at(i);
+        const QHash<QByteArray, int>::const_iterator it = previous.d->index.constFind(volume.key);
+        if (it == previous.d->index.constEnd() || matched.at(it.value())) {
+            result.added.append(volume.info);
+            continue;
+        }
+
+        matched[it.value()] = true;
+        const QStorageSnapshotPrivate::Volume &old = oldVolumes.at(it.value());
+        const bool spaceKnown = volume.bytesTotal != -1 && old.bytesTotal != -1;
+        if (volume.signature != old.signature
+                || (spaceKnown && (volume.bytesTotal != old.bytesTotal
+                                   || volume.bytesFree != old.bytesFree
+                                   || volume.bytesAvailable != old.bytesAvailable))) {
+            result.changed.append(volume.info);
+        }
+    }
+
+    for (int i = 0; i < oldVolumes.size(); ++i) {
+        if (!matched.at(i))
+            result.removed.append(oldVolumes.at(i).info);
+    }
+    return result;
+}
+
+/*!
+    Returns the key snapshots match \a volume by. A volume of one snapshot
+    and a volume of another are the same mount if their keys are equal, so
+    consumers can use the key to find the entries that the volumes diff()
+    reports stand for.
+*/
+QByteArray QStorageSnapshot::volumeKey(const QStorageInfo &volume)
+{
+    return snapshotKey(volume.mountId(), volume.rootPath(), volume.device());
+}
+
+/*!
+    Returns a snapshot of the currently mounted volumes. \a flags selects
+    the volumes and whether they are queried, just like for
+    QStorageInfo::forEachMountedVolume().
+*/
+QStorageSnapshot QStorageSnapshot::current(QStorageInfo::MountedVolumesFlags flags)
+{
+    QStorageSnapshot result;
+    QStorageSnapshotPrivate *dd = result.d.data();
+    const bool retrieveInfo = !(flags & QStorageInfo::SkipVolumeInfo);
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    const QStorageMountTable table = QStorageInfoPrivate::mountTable();
+    if (table.valid) {
+        dd->volumes.reserve(table.entries.size());
+        dd->index.reserve(table.entries.size());
+        for (int i = 0; i < table.entries.size(); ++i) {
+            const QStorageMountEntry &entry = table.entries.at(i);
+            if (entry.pseudo && !(flags & QStorageInfo::IncludePseudoFileSystems))
+                continue;
+            dd->append(QStorageInfoPrivate::fromMountEntry(entry, retrieveInfo),
+                       snapshotKey(entry.mountId, entry.rootPath, entry.device),
+                       snapshotSignature(entry.rootPath, entry.fileSystemType, entry.options),
+                       retrieveInfo);
+        }
+        return result;
+    }
+#endif
+
+    foreach (const QStorageInfo &info, QStorageInfo::mountedVolumes()) {
+        dd->append(info, snapshotKey(-1, info.rootPath(), info.device()),
+                   snapshotSignature(info.rootPath(), info.fileSystemType(),
+                                     info.isReadOnly() ? "ro" : "rw"),
+                   retrieveInfo);
+    }
+    return result;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSTORAGESNAPSHOT_H
+#define QSTORAGESNAPSHOT_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qshareddata.h>
+
+#include "qstorageinfo.h"
+
+QT_BEGIN_NAMESPACE
+
+class QStorageSnapshotPrivate;
+class QSTORAGEINFO_EXPORT QStorageSnapshot
+{
+public:
+    struct Diff
+    {
+        QList<QStorageInfo> added;
+        QList<QStorageInfo> removed;
+        QList<QStorageInfo> changed;
+
+        inline bool isEmpty() const
+        { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+    };
+
+    QStorageSnapshot();
+    QStorageSnapshot(const QStorageSnapshot &other);
+    ~QStorageSnapshot();
+
+    QStorageSnapshot &operator=(const QStorageSnapshot &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    inline QStorageSnapshot &operator=(QStorageSnapshot &&other)
+    { qSwap(d, other.d); return *this; }
+#endif
+
+    inline void swap(QStorageSnapshot &other)
+    { qSwap(d, other.d); }
+
+    bool isEmpty() const;
+    int size() const;
+    QList<QStorageInfo> volumes() const;
+
+    Diff diff(const QStorageSnapshot &previous) const;
+
+    static QByteArray volumeKey(const QStorageInfo &volume);
+    static QStorageSnapshot current(QStorageInfo::MountedVolumesFlags flags = QStorageInfo::NoFlags);
+
+private:
+    QSharedDataPointer<QStorageSnapshotPrivate> d;
+};
+
+Q_DECLARE_SHARED(QStorageSnapshot)
+
+QT_END_NAMESPACE
+
+#endif // QSTORAGESNAPSHOT_H
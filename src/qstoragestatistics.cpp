@@ -0,0 +1,243 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qstoragestatistics_p.h"
+
+#include <QtCore/qmutex.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QStorageStatistics
+    \inmodule QtCore
+    \brief Holds counters about the work QStorageInfo did to answer queries.
+
+    \ingroup io
+
+    When QStorageInfo shows up in a profile, the statistics tell where the
+    time went: resolving paths, reading the mount table, querying volumes
+    with statvfs() or scanning the device links for labels. They are
+    collected for the whole process once enabled with
+    QStorageInfo::setStatisticsEnabled(), and QStorageInfo::statistics()
+    returns a copy of their current state:
+
+    \code
+    QStorageInfo::setStatisticsEnabled(true);
+    ...
+    const QStorageStatistics statistics = QStorageInfo::statistics();
+    qDebug() << statistics.count(QStorageStatistics::StatCalls)
+             << statistics.nsecsElapsed(QStorageStatistics::StatPhase);
+    \endcode
+
+    Besides the totals, the time of every statvfs() call is recorded in a
+    latency histogram per volume, which helps to spot slow mounts.
+
+    The counters are updated independently of each other, so a copy taken
+    while other threads query volumes need not be consistent. Statistics are
+    currently only collected on Unix systems other than OS X; elsewhere most
+    counters stay at zero.
+
+    \sa QStorageInfo::statistics()
+*/
+
+/*!
+    \enum QStorageStatistics::Counter
+
+    This enum describes the events that are counted.
+
+    \value FilesOpened          Attempts to open files and directories,
+                                like the mount table.
+    \value MountEntriesParsed   Entries read from the mount table.
+    \value StatCalls            Volumes that were queried with statvfs().
+    \value LinksRead            Symbolic links that were read to find the
+                                labels and UUIDs of devices.
+    \value CacheHits            Lookups answered by the cached mount table
+                                or device index.
+    \value CacheMisses          Lookups that had to read the mount table or
+                                the device links again.
+    \omitvalue CounterCount
+*/
+
+/*!
+    \enum QStorageStatistics::Phase
+
+    This enum describes the phases whose time is measured.
+
+    \value CanonicalPathPhase   Resolving paths to canonical ones.
+    \value MountTablePhase      Reading and parsing the mount table.
+    \value StatPhase            Querying volumes with statvfs(), including
+                                the time spent waiting for a query timeout.
+    \value DeviceLinkPhase      Scanning the by-label, by-uuid and
+                                by-partuuid directories.
+    \omitvalue PhaseCount
+*/
+
+/*!
+    Constructs a QStorageStatistics object with all counters set to zero.
+*/
+QStorageStatistics::QStorageStatistics()
+{
+    for (int i = 0; i < CounterCount; ++i)
+        counters[i] = 0;
+    for (int i = 0; i < PhaseCount; ++i)
+        phaseNsecs[i] = 0;
+}
+
+/*!
+    Returns how often the event \a counter happened.
+*/
+quint64 QStorageStatistics::count(Counter counter) const
+{
+    return counter >= 0 && counter < CounterCount ? counters[counter] : 0;
+}
+
+/*!
+    Returns the time in nanoseconds spent in \a phase, summed over all
+    threads.
+*/
+qint64 QStorageStatistics::nsecsElapsed(Phase phase) const
+{
+    return phase >= 0 && phase < PhaseCount ? phaseNsecs[phase] : 0;
+}
+
+/*!
+    Returns the root paths of the volumes for which statvfs() latencies
+    were recorded.
+
+    \sa statLatencyHistogram()
+*/
+QStringList QStorageStatistics::statLatencyRootPaths() const
+{
+    return histograms.keys();
+}
+
+/*!
+    Returns the number of statvfs() calls for the volume mounted on
+    \a rootPath per latency bucket, or an empty vector if the volume was not
+    queried. The vector has LatencyBucketCount elements; the limits of the
+    buckets are returned by latencyBucketLimit().
+
+    \sa statLatencyRootPaths()
+*/
+QVector<quint64> QStorageStatistics::statLatencyHistogram(const QString &rootPath) const
+{
+    return histograms.value(rootPath);
+}
+
+/*!
+    Returns the upper limit in nanoseconds, exclusive, of the latencies
+    counted in \a bucket, or -1 for the last bucket, which has no limit.
+    The limits grow tenfold from 10 microseconds for the first bucket to
+    10 seconds.
+*/
+qint64 QStorageStatistics::latencyBucketLimit(int bucket)
+{
+    if (bucket < 0 || bucket >= LatencyBucketCount - 1)
+        return -1;
+    qint64 limit = 10000;
+    while (bucket-- > 0)
+        limit *= 10;
+    return limit;
+}
+
+static int latencyBucket(qint64 nsecs)
+{
+    int bucket = 0;
+    for (qint64 limit = 10000; bucket < QStorageStatistics::LatencyBucketCount - 1; limit *= 10) {
+        if (nsecs < limit)
+            break;
+        ++bucket;
+    }
+    return bucket;
+}
+
+struct QStorageLatencyHistograms
+{
+    QMutex mutex;
+    QHash<QString, QVector<quint64> > histograms;
+};
+
+Q_GLOBAL_STATIC(QStorageLatencyHistograms, latencyHistograms)
+
+QBasicAtomicInt QStorageStatisticsCollector::enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+QBasicAtomicInteger<quint64> QStorageStatisticsCollector::counters[QStorageStatistics::CounterCount];
+QBasicAtomicInteger<qint64> QStorageStatisticsCollector::phaseNsecs[QStorageStatistics::PhaseCount];
+
+void QStorageStatisticsCollector::addStatLatency(const QString &rootPath, qint64 nsecs)
+{
+    // a negative time means that the timer did not run
+    QStorageLatencyHistograms *latencies = nsecs < 0 ? Q_NULLPTR : latencyHistograms();
+    if (!latencies)
+        return;
+
+    QMutexLocker locker(&latencies->mutex);
+    QVector<quint64> &histogram = latencies->histograms[rootPath];
+    if (histogram.isEmpty())
+        histogram.fill(0, QStorageStatistics::LatencyBucketCount);
+    ++histogram[latencyBucket(nsecs)];
+}
+
+void QStorageStatisticsCollector::setEnabled(bool enable)
+{
+    enabled.store(enable ? 1 : 0);
+}
+
+QStorageStatistics QStorageStatisticsCollector::snapshot()
+{
+    QStorageStatistics result;
+    for (int i = 0; i < QStorageStatistics::CounterCount; ++i)
+        result.counters[i] = counters[i].load();
+    for (int i = 0; i < QStorageStatistics::PhaseCount; ++i)
+        result.phaseNsecs[i] = phaseNsecs[i].load();
+
+    if (QStorageLatencyHistograms *latencies = latencyHistograms()) {
+        QMutexLocker locker(&latencies->mutex);
+        result.histograms = latencies->histograms;
+    }
+    return result;
+}
+
+void QStorageStatisticsCollector::reset()
+{
+    for (int i = 0; i < QStorageStatistics::CounterCount; ++i)
+        counters[i].store(0);
+    for (int i = 0; i < QStorageStatistics::PhaseCount; ++i)
+        phaseNsecs[i].store(0);
+
+    if (QStorageLatencyHistograms *latencies = latencyHistograms()) {
+        QMutexLocker locker(&latencies->mutex);
+        latencies->histograms.clear();
+    }
+}
+
+QT_END_NAMESPACE
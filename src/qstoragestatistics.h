@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSTORAGESTATISTICS_H
+#define QSTORAGESTATISTICS_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSTORAGEINFO_EXPORT QStorageStatistics
+{
+public:
+    enum Counter {
+        FilesOpened,
+        MountEntriesParsed,
+        StatCalls,
+        LinksRead,
+        CacheHits,
+        CacheMisses,
+        CounterCount
+    };
+
+    enum Phase {
+        CanonicalPathPhase,
+        MountTablePhase,
+        StatPhase,
+        DeviceLinkPhase,
+        PhaseCount
+    };
+
+    enum { LatencyBucketCount = 8 };
+
+    QStorageStatistics();
+
+    quint64 count(Counter counter) const;
+    qint64 nsecsElapsed(Phase phase) const;
+
+    QStringList statLatencyRootPaths() const;
+    QVector<quint64> statLatencyHistogram(const QString &rootPath) const;
+    static qint64 latencyBucketLimit(int bucket);
+
+private:
+    friend class QStorageStatisticsCollector;
+
+    quint64 counters[CounterCount];
+    qint64 phaseNsecs[PhaseCount];
+    QHash<QString, QVector<quint64> > histograms;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSTORAGESTATISTICS_H
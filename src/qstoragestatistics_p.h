@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QSTORAGESTATISTICS_P_H
+#define QSTORAGESTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qstoragestatistics.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
+
+QT_BEGIN_NAMESPACE
+
+// The process wide counters behind QStorageInfo::statistics(). While
+// statistics are disabled, which is the default, every hook costs one
+// relaxed load.
+class QStorageStatisticsCollector
+{
+public:
+    static inline bool isEnabled()
+    { return enabled.load() != 0; }
+
+    static inline void count(QStorageStatistics::Counter counter)
+    {
+        if (isEnabled())
+            counters[counter].fetchAndAddRelaxed(1);
+    }
+
+    static inline void addTime(QStorageStatistics::Phase phase, qint64 nsecs)
+    { phaseNsecs[phase].fetchAndAddRelaxed(nsecs); }
+
+    static void addStatLatency(const QString &rootPath, qint64 nsecs);
+
+    static void setEnabled(bool enable);
+    static QStorageStatistics snapshot();
+    static void reset();
+
+private:
+    static QBasicAtomicInt enabled;
+    static QBasicAtomicInteger<quint64> counters[QStorageStatistics::CounterCount];
+    static QBasicAtomicInteger<qint64> phaseNsecs[QStorageStatistics::PhaseCount];
+};
+
+// Adds the time between construction and stop(), or destruction, to a phase.
+class QStoragePhaseTimer
+{
+public:
+    explicit inline QStoragePhaseTimer(QStorageStatistics::Phase phase) :
+        phase(phase), running(QStorageStatisticsCollector::isEnabled())
+    {
+        if (running)
+            timer.start();
+    }
+
+    inline ~QStoragePhaseTimer()
+    { stop(); }
+
+    // returns the elapsed time, or -1 if statistics are disabled
+    inline qint64 stop()
+    {
+        if (!running)
+            return -1;
+        running = false;
+        const qint64 nsecs = timer.nsecsElapsed();
+        QStorageStatisticsCollector::addTime(phase, nsecs);
+        return nsecs;
+    }
+
+private:
+    QElapsedTimer timer;
+    QStorageStatistics::Phase phase;
+    bool running;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSTORAGESTATISTICS_P_H
@@ -0,0 +1,423 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "qstoragewatcher.h"
+#include "qstorageinfo_p.h"
+
+#include <QtCore/qfuturewatcher.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/qtimer.h>
+
+#if defined(Q_OS_LINUX)
+#include <QtCore/private/qcore_unix_p.h>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+#if defined(Q_OS_LINUX)
+static const char pathMountsNotifier[] = "/proc/self/mounts";
+#endif
+static const int pollInterval = 2000;
+
+class QStorageWatcherPrivate
+{
+    Q_DECLARE_PUBLIC(QStorageWatcher)
+public:
+    struct Volume
+    {
+        inline Volume() : bytesTotal(-1), bytesFree(-1), bytesAvailable(-1) {}
+
+        void setSpace(const QStorageInfo &volume);
+        bool spaceDiffers(const Volume &other) const;
+
+        QStorageInfo info;
+        QByteArray signature;
+        // the space at the last check, -1 if it was not checked yet
+        qint64 bytesTotal;
+        qint64 bytesFree;
+        qint64 bytesAvailable;
+    };
+    typedef QHash<QString, Volume> Volumes;
+
+    explicit QStorageWatcherPrivate(QStorageWatcher *qq);
+    ~QStorageWatcherPrivate();
+
+    void _q_mountsChanged();
+    void _q_volumesRetrieved();
+    void _q_checkSpace();
+
+    void update(const Volumes &current);
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    static Volumes currentVolumes();
+#endif
+
+    QStorageWatcher *q_ptr;
+    QSocketNotifier *notifier;
+    int notifierFd;
+    QFutureWatcher<QStorageInfo> *retrieval;
+    QTimer *spaceTimer;
+    bool initialized;
+    Volumes volumes;
+};
+
+QStorageWatcherPrivate::QStorageWatcherPrivate(QStorageWatcher *qq) :
+    q_ptr(qq),
+    notifier(Q_NULLPTR),
+    notifierFd(-1),
+    retrieval(Q_NULLPTR),
+    spaceTimer(Q_NULLPTR),
+    initialized(false)
+{
+}
+
+QStorageWatcherPrivate::~QStorageWatcherPrivate()
+{
+    delete notifier;
+#if defined(Q_OS_LINUX)
+    if (notifierFd != -1)
+        qt_safe_close(notifierFd);
+#endif
+}
+
+static QByteArray volumeSignature(const QByteArray &device,
+                                  const QByteArray &fileSystemType,
+                                  const QByteArray &options)
+{
+    QByteArray result = device;
+    result += '\0';
+    result += fileSystemType;
+    result += '\0';
+    result += options;
+    return result;
+}
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+QStorageWatcherPrivate::Volumes QStorageWatcherPrivate::currentVolumes()
+{
+    Volumes result;
+
+    // only the mount table is read here, volumes are stat'ed when reported
+    const QStorageMountTable table = QStorageInfoPrivate::mountTable();
+    for (int i = 0; i < table.entries.size(); ++i) {
+        const QStorageMountEntry &entry = table.entries.at(i);
+        if (entry.pseudo)
+            continue;
+
+        Volume volume;
+        volume.info = QStorageInfoPrivate::fromMountEntry(entry, false);
+        volume.signature = volumeSignature(entry.device, entry.fileSystemType, entry.options);
+        result.insert(entry.rootPath, volume);
+    }
+
+    return result;
+}
+#endif
+
+void QStorageWatcherPrivate::_q_mountsChanged()
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    update(currentVolumes());
+#else
+    // Without a mount table, listing the volumes means querying each of
+    // them, which must not block the thread of the watcher. A check that is
+    // still running when the next one is due covers it as well.
+    if (!retrieval->isRunning())
+        retrieval->setFuture(QStorageInfo::mountedVolumesAsync());
+#endif
+}
+
+void QStorageWatcherPrivate::_q_volumesRetrieved()
+{
+    Volumes current;
+    foreach (const QStorageInfo &info, retrieval->future().results()) {
+        Volume volume;
+        volume.info = info;
+        volume.signature = volumeSignature(info.device(), info.fileSystemType(),
+                                           info.isReadOnly() ? "ro" : "rw");
+        // the listing queried the space as well
+        volume.setSpace(info);
+        current.insert(info.rootPath(), volume);
+    }
+
+    // the first result is what later ones are compared with
+    if (!initialized) {
+        volumes = current;
+        initialized = true;
+        return;
+    }
+    update(current);
+}
+
+void QStorageWatcherPrivate::update(const Volumes &current)
+{
+    Q_Q(QStorageWatcher);
+
+    const Volumes previous = volumes;
+    volumes = current;
+
+    QList<QStorageInfo> unmounted;
+    for (Volumes::const_iterator it = previous.constBegin(); it != previous.constEnd(); ++it) {
+        if (!volumes.contains(it.key()))
+            unmounted.append(it->info);
+    }
+
+    QList<QStorageInfo> mounted;
+    QList<QStorageInfo> changed;
+    QList<QStorageInfo> spaceChanged;
+    for (Volumes::iterator it = volumes.begin(); it != volumes.end(); ++it) {
+        const Volumes::const_iterator old = previous.constFind(it.key());
+        if (old != previous.constEnd()) {
+            if (old->signature == it->signature) {
+                if (it->bytesTotal == -1) {
+                    // only the mount table was read, keep what was known
+                    *it = *old;
+                } else if (spaceTimer && spaceTimer->isActive() && it->spaceDiffers(*old)) {
+                    spaceChanged.append(it->info);
+                }
+                continue;
+            }
+            changed.append(it->info);
+        } else {
+            mounted.append(it->info);
+        }
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+        // whatever was cached about the mount point is out of date
+        QStorageInfoPrivate::invalidate(it->info);
+#endif
+    }
+
+    foreach (const QStorageInfo &info, unmounted)
+        emit q->volumeUnmounted(info);
+    foreach (const QStorageInfo &info, mounted)
+        emit q->volumeMounted(info);
+    foreach (const QStorageInfo &info, changed)
+        emit q->volumeChanged(info);
+    foreach (const QStorageInfo &info, spaceChanged)
+        emit q->volumeSpaceChanged(info);
+}
+
+void QStorageWatcherPrivate::Volume::setSpace(const QStorageInfo &volume)
+{
+    bytesTotal = volume.bytesTotal();
+    bytesFree = volume.bytesFree();
+    bytesAvailable = volume.bytesAvailable();
+}
+
+// Compares the space the same way QStorageSnapshot::diff() does: a volume
+// whose space is not known on either side has not changed.
+bool QStorageWatcherPrivate::Volume::spaceDiffers(const Volume &other) const
+{
+    return bytesTotal != -1 && other.bytesTotal != -1
+            && (bytesTotal != other.bytesTotal
+                || bytesFree != other.bytesFree
+                || bytesAvailable != other.bytesAvailable);
+}
+
+void QStorageWatcherPrivate::_q_checkSpace()
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    Q_Q(QStorageWatcher);
+
+    // Only the space is queried, through the shared cache, so every other
+    // QStorageInfo object for the volume sees the new values as well.
+    QList<QStorageInfo> changed;
+    for (Volumes::iterator it = volumes.begin(); it != volumes.end(); ++it) {
+        it->info.refreshSpace();
+        Volume checked = *it;
+        checked.setSpace(it->info);
+        if (checked.spaceDiffers(*it))
+            changed.append(it->info);
+        *it = checked;
+    }
+
+    foreach (const QStorageInfo &info, changed)
+        emit q->volumeSpaceChanged(info);
+#else
+    // the listing queries the space of every volume as well
+    _q_mountsChanged();
+#endif
+}
+
+/*!
+    \class QStorageWatcher
+    \inmodule QtCore
+    \brief Notifies about mounted, unmounted and remounted volumes.
+
+    \ingroup io
+
+    QStorageWatcher reports changes of the set of mounted filesystems through
+    the event loop, so there is no need to poll QStorageInfo::mountedVolumes()
+    and compare the results by hand. Pseudo filesystems are ignored, just like
+    QStorageInfo::mountedVolumes() does.
+
+    On Linux, the watcher is woken up by the kernel whenever the mount table of
+    the process changes. On other Unix systems the mount table is checked
+    every two seconds. Elsewhere the volumes are listed every two seconds
+    by mountedVolumesAsync() in the global thread pool, so that a slow volume
+    never blocks the thread of the watcher; changes that happen before the
+    first listing completes are not reported.
+
+    The kernel does not report how full a filesystem is, so the space of the
+    volumes is only watched if a space check interval is set with
+    setSpaceCheckInterval(). volumeSpaceChanged() is then emitted for every
+    volume whose space differs from the previous check.
+
+    \sa QStorageInfo, QStorageSnapshot
+*/
+
+/*!
+    Constructs a QStorageWatcher object with the given \a parent and starts
+    watching the mounted volumes.
+*/
+QStorageWatcher::QStorageWatcher(QObject *parent)
+    : QObject(parent),
+      d_ptr(new QStorageWatcherPrivate(this))
+{
+    Q_D(QStorageWatcher);
+
+#if defined(Q_OS_LINUX)
+    // open the descriptor first, so that no change can slip in while the
+    // initial list of volumes is read
+    d->notifierFd = qt_safe_open(pathMountsNotifier, O_RDONLY);
+    if (d->notifierFd != -1) {
+        d->notifier = new QSocketNotifier(d->notifierFd, QSocketNotifier::Exception);
+        connect(d->notifier, SIGNAL(activated(int)), this, SLOT(_q_mountsChanged()));
+    }
+#endif
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    d->volumes = QStorageWatcherPrivate::currentVolumes();
+    d->initialized = true;
+#else
+    d->retrieval = new QFutureWatcher<QStorageInfo>(this);
+    connect(d->retrieval, SIGNAL(finished()), this, SLOT(_q_volumesRetrieved()));
+    d->_q_mountsChanged();
+#endif
+
+    if (!d->notifier) {
+        QTimer *timer = new QTimer(this);
+        connect(timer, SIGNAL(timeout()), this, SLOT(_q_mountsChanged()));
+        timer->start(pollInterval);
+    }
+}
+
+/*!
+    Destroys the QStorageWatcher object.
+*/
+QStorageWatcher::~QStorageWatcher()
+{
+}
+
+/*!
+    Returns the interval in milliseconds at which the space of the volumes is
+    checked, or 0 if it is not watched, which is the default.
+
+    \sa setSpaceCheckInterval(), volumeSpaceChanged()
+*/
+int QStorageWatcher::spaceCheckInterval() const
+{
+    Q_D(const QStorageWatcher);
+    return d->spaceTimer && d->spaceTimer->isActive() ? d->spaceTimer->interval() : 0;
+}
+
+/*!
+    Makes the watcher check the space of the mounted volumes every \a msec
+    milliseconds and emit volumeSpaceChanged() for the volumes whose space
+    has changed since the previous check. A value of 0 or less stops
+    watching the space.
+
+    On Unix systems, the space is retrieved with QStorageInfo::refreshSpace()
+    in the thread of the watcher, so every QStorageInfo object for a volume
+    sees the new values, and QStorageInfo::queryTimeout() applies. Elsewhere
+    the volumes are listed by QStorageInfo::mountedVolumesAsync() at this
+    interval, and mount changes are reported at it as well.
+
+    Changes are reported relative to the previous check, so the first check
+    after a volume is mounted only records its space.
+
+    \sa spaceCheckInterval()
+*/
+void QStorageWatcher::setSpaceCheckInterval(int msec)
+{
+    Q_D(QStorageWatcher);
+    if (msec <= 0) {
+        if (d->spaceTimer)
+            d->spaceTimer->stop();
+        return;
+    }
+
+    if (!d->spaceTimer) {
+        d->spaceTimer = new QTimer(this);
+        connect(d->spaceTimer, SIGNAL(timeout()), this, SLOT(_q_checkSpace()));
+    }
+    d->spaceTimer->start(msec);
+}
+
+/*!
+    \fn void QStorageWatcher::volumeMounted(const QStorageInfo &volume)
+
+    This signal is emitted when a new \a volume has been mounted.
+*/
+
+/*!
+    \fn void QStorageWatcher::volumeUnmounted(const QStorageInfo &volume)
+
+    This signal is emitted when \a volume has been unmounted.
+
+    As the filesystem is gone, only rootPath(), device() and fileSystemType()
+    of \a volume are guaranteed to be meaningful.
+*/
+
+/*!
+    \fn void QStorageWatcher::volumeChanged(const QStorageInfo &volume)
+
+    This signal is emitted when \a volume has been remounted, for example
+    read-only, or mounted with different options or from another device on
+    the same mount point.
+*/
+
+/*!
+    \fn void QStorageWatcher::volumeSpaceChanged(const QStorageInfo &volume)
+
+    This signal is emitted when the total, free or available space of
+    \a volume has changed. It is only emitted if a space check interval is
+    set.
+
+    \sa setSpaceCheckInterval()
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qstoragewatcher.cpp"
@@ -0,0 +1,74 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#ifndef QSTORAGEWATCHER_H
+#define QSTORAGEWATCHER_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qscopedpointer.h>
+
+#include "qstorageinfo.h"
+
+QT_BEGIN_NAMESPACE
+
+class QStorageWatcherPrivate;
+class QSTORAGEINFO_EXPORT QStorageWatcher : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QStorageWatcher)
+    Q_DISABLE_COPY(QStorageWatcher)
+public:
+    explicit QStorageWatcher(QObject *parent = Q_NULLPTR);
+    ~QStorageWatcher();
+
+    int spaceCheckInterval() const;
+    void setSpaceCheckInterval(int msec);
+
+Q_SIGNALS:
+    void volumeMounted(const QStorageInfo &volume);
+    void volumeUnmounted(const QStorageInfo &volume);
+    void volumeChanged(const QStorageInfo &volume);
+    void volumeSpaceChanged(const QStorageInfo &volume);
+
+private:
+    Q_PRIVATE_SLOT(d_func(), void _q_mountsChanged())
+    Q_PRIVATE_SLOT(d_func(), void _q_volumesRetrieved())
+    Q_PRIVATE_SLOT(d_func(), void _q_checkSpace())
+
+    QScopedPointer<QStorageWatcherPrivate> d_ptr;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSTORAGEWATCHER_H
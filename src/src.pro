@@ -10,15 +10,27 @@ DEFINES *= QT_NO_CAST_FROM_BYTEARRAY QT_NO_CAST_FROM_ASCII QT_NO_CAST_TO_ASCII
 
 #HEADERS += qtdriveinfoglobal.h
 HEADERS += qstorageinfo.h \
-           qstorageinfo_p.h
-SOURCES += qstorageinfo.cpp
+           qstorageinfo_p.h \
+           qstorageiterator.h \
+           qstorageiterator_p.h \
+           qstoragesnapshot.h \
+           qstoragestatistics.h \
+           qstoragestatistics_p.h \
+           qstoragewatcher.h
+SOURCES += qstorageinfo.cpp \
+           qstorageiterator.cpp \
+           qstoragesnapshot.cpp \
+           qstoragestatistics.cpp \
+           qstoragewatcher.cpp
 
 win* {
-    SOURCES += qstorageinfo_win.cpp
+    SOURCES += qstorageinfo_win.cpp \
+               qstorageiterator_stub.cpp
     LIBS += -lNetapi32 -lMpr -luser32 -lWinmm
 }
 
 unix {
+    SOURCES += qstorageiterator_unix.cpp
     macx {
         SOURCES += qstorageinfo_mac.cpp
         LIBS += -framework CoreServices -framework DiskArbitration -framework IOKit
@@ -1,2 +1,2 @@
 TEMPLATE = subdirs
-SUBDIRS += qstorageinfo
+SUBDIRS += qstorageinfo qstorageiterator qstoragesnapshot qstoragestatistics qstoragewatcher
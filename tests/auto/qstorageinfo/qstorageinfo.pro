@@ -1,7 +1,7 @@
 TEMPLATE = app
 QT += core testlib
 CONFIG -= app_bundle
-CONFIG += console
+CONFIG += console c++11
 
 SOURCES += tst_qstorageinfo.cpp
 INCLUDEPATH += $$PWD/../../../include
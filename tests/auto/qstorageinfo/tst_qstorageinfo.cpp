@@ -35,6 +35,13 @@
 
 #include <QStorageInfo>
 
+#if defined(Q_OS_LINUX)
+#include "../../../src/qstorageinfo_p.h"
+#include "../../../src/qstorageiterator_p.h"
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#endif
+
 class tst_QStorageInfo : public QObject
 {
     Q_OBJECT
@@ -42,13 +49,24 @@ private slots:
     void defaultValues();
     void invalidStorage();
     void operatorEqual();
+    void fileSystemTraits();
 #ifndef Q_OS_WINRT
     void operatorNotEqual();
     void root();
     void currentStorage();
     void storageList();
+    void storageListAsync();
+    void forEachMountedVolume();
+    void forPaths();
     void tempFile();
     void caching();
+    void refreshSpace();
+    void sharedCache();
+    void queryTimeout();
+    void fileSystemStatistics();
+    void ioGeometry();
+    void syntheticMountTable();
+    void slowVolume();
 #endif
 };
 
@@ -62,9 +80,26 @@ void tst_QStorageInfo::defaultValues()
     QVERIFY(!storage.isRoot());
     QVERIFY(storage.device().isEmpty());
     QVERIFY(storage.fileSystemType().isEmpty());
+    QVERIFY(storage.uuid().isEmpty());
+    QVERIFY(storage.partitionUuid().isEmpty());
+    QVERIFY(!storage.hasTimedOut());
+    QCOMPARE(storage.mountId(), -1);
+    QCOMPARE(storage.majorDeviceNumber(), -1);
     QVERIFY(storage.bytesTotal() == -1);
     QVERIFY(storage.bytesFree() == -1);
     QVERIFY(storage.bytesAvailable() == -1);
+    QVERIFY(storage.filesTotal() == -1);
+    QVERIFY(storage.filesFree() == -1);
+    QVERIFY(storage.filesAvailable() == -1);
+    QCOMPARE(storage.blockSize(), -1);
+    QCOMPARE(storage.fragmentSize(), -1);
+    QCOMPARE(storage.maximumFileNameLength(), -1);
+    QCOMPARE(storage.mountFlags(), QStorageInfo::MountFlags());
+    QCOMPARE(storage.ioBlockSize(), -1);
+    QCOMPARE(storage.logicalBlockSize(), -1);
+    QCOMPARE(storage.optimalIoSize(), -1);
+    QVERIFY(storage.maximumTransferSize() == -1);
+    QCOMPARE(storage.deviceFlags(), QStorageInfo::DeviceFlags());
 }
 
 void tst_QStorageInfo::invalidStorage()
@@ -77,11 +112,43 @@ void tst_QStorageInfo::invalidStorage()
     QVERIFY(!storage.isRoot());
     QVERIFY(storage.device().isEmpty());
     QVERIFY(storage.fileSystemType().isEmpty());
+    QVERIFY(storage.uuid().isEmpty());
+    QVERIFY(storage.partitionUuid().isEmpty());
+    QVERIFY(!storage.hasTimedOut());
+    QCOMPARE(storage.mountId(), -1);
+    QCOMPARE(storage.majorDeviceNumber(), -1);
     QVERIFY(storage.bytesTotal() == -1);
     QVERIFY(storage.bytesFree() == -1);
     QVERIFY(storage.bytesAvailable() == -1);
 }
 
+void tst_QStorageInfo::fileSystemTraits()
+{
+    QCOMPARE(QStorageInfo().fileSystemTraits(), QStorageInfo::FileSystemTraits());
+
+    QCOMPARE(QStorageInfo::fileSystemTraits("ext4"),
+             QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels);
+    QCOMPARE(QStorageInfo::fileSystemTraits("NTFS"),
+             QStorageInfo::LocalBlockDevice | QStorageInfo::SupportsLabels);
+    QCOMPARE(QStorageInfo::fileSystemTraits("nfs4"),
+             QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock);
+    QCOMPARE(QStorageInfo::fileSystemTraits("fuse.sshfs"),
+             QStorageInfo::NetworkFileSystem | QStorageInfo::MayBlock);
+    QCOMPARE(QStorageInfo::fileSystemTraits("cgroup2"),
+             QStorageInfo::FileSystemTraits(QStorageInfo::PseudoFileSystem));
+    QCOMPARE(QStorageInfo::fileSystemTraits("tmpfs"),
+             QStorageInfo::FileSystemTraits(QStorageInfo::PseudoFileSystem));
+    QCOMPARE(QStorageInfo::fileSystemTraits("no-such-filesystem"), QStorageInfo::FileSystemTraits());
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    // the volumes we list are never pseudo filesystems
+    foreach (const QStorageInfo &storage, QStorageInfo::mountedVolumes()) {
+        if (!storage.isRoot())
+            QVERIFY(!storage.fileSystemTraits().testFlag(QStorageInfo::PseudoFileSystem));
+    }
+#endif
+}
+
 void tst_QStorageInfo::operatorEqual()
 {
     {
@@ -121,6 +188,12 @@ void tst_QStorageInfo::root()
     QVERIFY(storage.isRoot());
     QVERIFY(!storage.device().isEmpty());
     QVERIFY(!storage.fileSystemType().isEmpty());
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+    QVERIFY(storage.mountId() >= 0);
+    QVERIFY(storage.parentMountId() >= 0);
+    QVERIFY(storage.majorDeviceNumber() >= 0);
+    QVERIFY(!storage.fileSystemRoot().isEmpty());
+#endif
 #ifndef Q_OS_HAIKU
     QVERIFY(storage.bytesTotal() >= 0);
     QVERIFY(storage.bytesFree() >= 0);
@@ -166,6 +239,87 @@ void tst_QStorageInfo::storageList()
     }
 }
 
+void tst_QStorageInfo::storageListAsync()
+{
+    const QList<QStorageInfo> volumes = QStorageInfo::mountedVolumes();
+
+    QFuture<QStorageInfo> future = QStorageInfo::mountedVolumesAsync();
+    future.waitForFinished();
+    const QList<QStorageInfo> asyncVolumes = future.results();
+
+    QCOMPARE(asyncVolumes.size(), volumes.size());
+    QVERIFY(asyncVolumes.contains(QStorageInfo::root()));
+    for (int i = 0; i < volumes.size(); ++i)
+        QCOMPARE(asyncVolumes.at(i).rootPath(), volumes.at(i).rootPath());
+}
+
+static bool appendVolume(const QStorageInfo &volume, void *context)
+{
+    static_cast<QList<QStorageInfo> *>(context)->append(volume);
+    return true;
+}
+
+void tst_QStorageInfo::forEachMountedVolume()
+{
+    const QList<QStorageInfo> volumes = QStorageInfo::mountedVolumes();
+
+    QList<QStorageInfo> enumerated;
+    QStorageInfo::forEachMountedVolume([&enumerated](const QStorageInfo &storage) {
+        enumerated.append(storage);
+        return true;
+    });
+    QCOMPARE(enumerated.size(), volumes.size());
+    for (int i = 0; i < volumes.size(); ++i) {
+        QCOMPARE(enumerated.at(i).rootPath(), volumes.at(i).rootPath());
+        QCOMPARE(enumerated.at(i).device(), volumes.at(i).device());
+    }
+
+    // stopping after the first volume
+    int calls = 0;
+    QStorageInfo::forEachMountedVolume([&calls](const QStorageInfo &) {
+        ++calls;
+        return false;
+    });
+    QCOMPARE(calls, volumes.isEmpty() ? 0 : 1);
+
+    // a plain function with a context pointer
+    QList<QStorageInfo> appended;
+    QStorageInfo::forEachMountedVolume(appendVolume, &appended);
+    QCOMPARE(appended.size(), volumes.size());
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    // pseudo filesystems are only passed on request
+    int all = 0;
+    QStorageInfo::forEachMountedVolume([&all](const QStorageInfo &storage) {
+        ++all;
+        return !storage.rootPath().isEmpty();
+    }, QStorageInfo::IncludePseudoFileSystems | QStorageInfo::SkipVolumeInfo);
+    QVERIFY(all >= volumes.size());
+#endif
+}
+
+void tst_QStorageInfo::forPaths()
+{
+    const QString appPath = QCoreApplication::applicationFilePath();
+    const QString appDirPath = QCoreApplication::applicationDirPath();
+    const QString invalidPath = QStringLiteral("invalid/path");
+
+    const QHash<QString, QStorageInfo> volumes =
+            QStorageInfo::forPaths(QStringList() << appPath << appDirPath
+                                   << QDir::rootPath() << invalidPath << appPath);
+    QCOMPARE(volumes.size(), 4);
+
+    const QStorageInfo appStorage = volumes.value(appPath);
+    QVERIFY(appStorage.isValid());
+    QCOMPARE(appStorage.rootPath(), QStorageInfo(appPath).rootPath());
+    QCOMPARE(appStorage.device(), QStorageInfo(appPath).device());
+    QVERIFY(appStorage == volumes.value(appDirPath));
+
+    QVERIFY(volumes.value(QDir::rootPath()).isRoot());
+    QVERIFY(!volumes.value(invalidPath).isValid());
+    QVERIFY(volumes.value(invalidPath).rootPath().isEmpty());
+}
+
 void tst_QStorageInfo::tempFile()
 {
     QTemporaryFile file;
@@ -211,6 +365,330 @@ void tst_QStorageInfo::caching()
     QVERIFY(storage1 == storage2);
     QVERIFY(free != storage2.bytesFree());
 }
+
+void tst_QStorageInfo::refreshSpace()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    QStorageInfo storage1(file.fileName());
+#ifdef Q_OS_LINUX
+    if (storage1.fileSystemType() == "btrfs")
+        QSKIP("This test doesn't work on btrfs, probably due to a btrfs bug");
+#endif
+
+    qint64 free = storage1.bytesFree();
+    QStorageInfo storage2(storage1);
+
+    file.write(QByteArray(1024*1024, '\0'));
+    file.flush();
+
+    storage2.refreshSpace();
+    QVERIFY(storage1 == storage2);
+    QCOMPARE(storage2.rootPath(), storage1.rootPath());
+    QCOMPARE(storage2.name(), storage1.name());
+    QVERIFY(free != storage2.bytesFree());
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    // copies share the cache
+    QCOMPARE(storage1.bytesFree(), storage2.bytesFree());
+#else
+    // copies are detached
+    QCOMPARE(storage1.bytesFree(), free);
+#endif
+}
+
+void tst_QStorageInfo::sharedCache()
+{
+#if !defined(Q_OS_UNIX) || defined(Q_OS_MAC)
+    QSKIP("Volumes are only shared on Unix systems");
+#endif
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    QStorageInfo storage1(file.fileName());
+    QStorageInfo storage2(QFileInfo(file.fileName()).absolutePath());
+    QCOMPARE(storage1.rootPath(), storage2.rootPath());
+#ifdef Q_OS_LINUX
+    if (storage1.fileSystemType() == "btrfs")
+        QSKIP("This test doesn't work on btrfs, probably due to a btrfs bug");
+#endif
+
+    qint64 free = storage1.bytesFree();
+    QCOMPARE(storage2.bytesFree(), free);
+    file.write(QByteArray(1024*1024, '\0'));
+    file.flush();
+
+    // refreshing one object updates every object for the same volume
+    storage2.refresh();
+    QVERIFY(free != storage2.bytesFree());
+    QCOMPARE(storage1.bytesFree(), storage2.bytesFree());
+
+    // a new object for the volume queries it again, and the objects that
+    // already exist see that as well
+    free = storage1.bytesFree();
+    file.write(QByteArray(1024*1024, '\0'));
+    file.flush();
+    QStorageInfo storage3(file.fileName());
+    QVERIFY(storage3 == storage1);
+    QVERIFY(free != storage3.bytesFree());
+    QCOMPARE(storage1.bytesFree(), storage3.bytesFree());
+    QCOMPARE(storage2.bytesFree(), storage3.bytesFree());
+}
+
+void tst_QStorageInfo::queryTimeout()
+{
+    QCOMPARE(QStorageInfo::queryTimeout(), -1);
+
+    QStorageInfo::setQueryTimeout(10000);
+    QCOMPARE(QStorageInfo::queryTimeout(), 10000);
+
+    // the volume is only queried on first access, which has to happen while
+    // the timeout is set for the query to go through the workers
+    QStorageInfo storage(QCoreApplication::applicationFilePath());
+    storage.refresh();
+    const bool valid = storage.isValid();
+    const bool ready = storage.isReady();
+    const bool timedOut = storage.hasTimedOut();
+    const qint64 bytesTotal = storage.bytesTotal();
+    QStorageInfo::setQueryTimeout(-1);
+
+    QVERIFY(valid);
+    QVERIFY(ready);
+    QVERIFY(!timedOut);
+    QVERIFY(bytesTotal >= 0);
+}
+
+void tst_QStorageInfo::fileSystemStatistics()
+{
+    QStorageInfo storage = QStorageInfo::root();
+    QVERIFY(storage.isReady());
+    QCOMPARE(storage.isReadOnly(), storage.mountFlags().testFlag(QStorageInfo::ReadOnlyMount));
+
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+    struct statvfs buffer;
+    QCOMPARE(::statvfs("/", &buffer), 0);
+    QCOMPARE(storage.fragmentSize(), int(buffer.f_frsize));
+    QCOMPARE(storage.blockSize(), int(buffer.f_bsize));
+    QCOMPARE(storage.maximumFileNameLength(), int(buffer.f_namemax));
+    QCOMPARE(storage.filesTotal(), qint64(buffer.f_files));
+    QCOMPARE(storage.bytesTotal(), qint64(buffer.f_blocks) * qint64(buffer.f_frsize));
+    QCOMPARE(storage.mountFlags().testFlag(QStorageInfo::NoSuidMount),
+             (buffer.f_flag & ST_NOSUID) != 0);
+#else
+    QVERIFY(storage.fragmentSize() > 0 || storage.fragmentSize() == -1);
+#endif
+}
+
+#if defined(Q_OS_LINUX)
+static bool fakeStat(const QByteArray &rootPath, QStorageStatInfo *info)
+{
+    info->bytesTotal = 1000;
+    info->bytesFree = 600;
+    info->bytesAvailable = 500;
+    info->filesTotal = 100;
+    info->filesFree = 40;
+    info->filesAvailable = 30;
+    info->blockSize = 4096;
+    info->fragmentSize = 1024;
+    info->maximumFileNameLength = 255;
+    info->readOnly = rootPath == "/srv/data";
+    if (info->readOnly)
+        info->mountFlags = QStorageInfo::NoExecMount | QStorageInfo::NoAtimeMount;
+    return true;
+}
+#endif
+
+#if defined(Q_OS_LINUX)
+static bool writeAttribute(const QString &path, const QByteArray &value)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(value + '\n') == value.size() + 1;
+}
+#endif
+
+void tst_QStorageInfo::ioGeometry()
+{
+#if defined(Q_OS_LINUX)
+    struct stat st;
+    QCOMPARE(::stat("/", &st), 0);
+    QCOMPARE(QStorageInfo::root().ioBlockSize(), int(st.st_blksize));
+#endif
+
+#if defined(Q_OS_LINUX)
+    // 8:1 is a partition of sdz, 8:16 a disk of its own, 8:32 is unknown
+    QTemporaryDir blockDevices;
+    QVERIFY(blockDevices.isValid());
+    const QString root = blockDevices.path();
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sdz/sdz1")));
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sdz/queue")));
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sdy/queue")));
+    QVERIFY(QFile::link(root + QStringLiteral("/sdz/sdz1"), root + QStringLiteral("/8:1")));
+    QVERIFY(QFile::link(root + QStringLiteral("/sdy"), root + QStringLiteral("/8:16")));
+
+    const QString sdz = root + QStringLiteral("/sdz/queue/");
+    QVERIFY(writeAttribute(sdz + QStringLiteral("logical_block_size"), "512"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("physical_block_size"), "4096"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("minimum_io_size"), "4096"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("optimal_io_size"), "0"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("discard_granularity"), "0"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("max_sectors_kb"), "1280"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("rotational"), "1"));
+    QVERIFY(writeAttribute(sdz + QStringLiteral("zoned"), "none"));
+
+    const QString sdy = root + QStringLiteral("/sdy/queue/");
+    QVERIFY(writeAttribute(sdy + QStringLiteral("logical_block_size"), "4096"));
+    QVERIFY(writeAttribute(sdy + QStringLiteral("optimal_io_size"), "131072"));
+    QVERIFY(writeAttribute(sdy + QStringLiteral("discard_granularity"), "4096"));
+    QVERIFY(writeAttribute(sdy + QStringLiteral("rotational"), "0"));
+    QVERIFY(writeAttribute(sdy + QStringLiteral("dax"), "1"));
+    QVERIFY(writeAttribute(sdy + QStringLiteral("zoned"), "host-managed"));
+
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 8:16 / /srv/zoned rw - f2fs /dev/sdy rw\n"
+            "3 1 8:32 / /srv/other rw - xfs /dev/sdx rw\n");
+    qt_storage_setStatFunction(fakeStat);
+    qt_storage_setBlockDeviceRoot(root);
+
+    // the first access reads all of the I/O geometry
+    const QList<QStorageInfo> volumes = QStorageInfo::mountedVolumes();
+    foreach (const QStorageInfo &volume, volumes)
+        volume.deviceFlags();
+
+    qt_storage_setBlockDeviceRoot(QString());
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+
+    QCOMPARE(volumes.size(), 3);
+    QCOMPARE(volumes.at(0).logicalBlockSize(), 512);
+    QCOMPARE(volumes.at(0).physicalBlockSize(), 4096);
+    QCOMPARE(volumes.at(0).minimumIoSize(), 4096);
+    QCOMPARE(volumes.at(0).optimalIoSize(), 0);
+    QCOMPARE(volumes.at(0).discardGranularity(), qint64(0));
+    QCOMPARE(volumes.at(0).maximumTransferSize(), qint64(1280 * 1024));
+    QCOMPARE(volumes.at(0).deviceFlags(), QStorageInfo::DeviceFlags(QStorageInfo::RotationalDevice));
+
+    QCOMPARE(volumes.at(1).logicalBlockSize(), 4096);
+    QCOMPARE(volumes.at(1).physicalBlockSize(), -1);
+    QCOMPARE(volumes.at(1).optimalIoSize(), 131072);
+    QCOMPARE(volumes.at(1).discardGranularity(), qint64(4096));
+    QVERIFY(volumes.at(1).maximumTransferSize() == -1);
+    QCOMPARE(volumes.at(1).deviceFlags(),
+             QStorageInfo::DaxDevice | QStorageInfo::HostManagedZonedDevice);
+
+    QCOMPARE(volumes.at(2).logicalBlockSize(), -1);
+    QCOMPARE(volumes.at(2).deviceFlags(), QStorageInfo::DeviceFlags());
+#endif
+}
+
+void tst_QStorageInfo::syntheticMountTable()
+{
+#if defined(Q_OS_LINUX)
+    QTemporaryDir links;
+    QVERIFY(links.isValid());
+    QVERIFY(QDir(links.path()).mkdir(QStringLiteral("by-label")));
+    QVERIFY(QFile::link(QStringLiteral("/dev/sdz2"), links.path() + QStringLiteral("/by-label/DATA")));
+    QVERIFY(QDir(links.path()).mkdir(QStringLiteral("by-uuid")));
+    QVERIFY(QFile::link(QStringLiteral("/dev/sdz2"),
+                        links.path() + QStringLiteral("/by-uuid/0e5a3b2c-7d14-4f3a-9c61-2b8e5f0d4a17")));
+    QVERIFY(QDir(links.path()).mkdir(QStringLiteral("by-partuuid")));
+    QVERIFY(QFile::link(QStringLiteral("/dev/sdz2"),
+                        links.path() + QStringLiteral("/by-partuuid/6c1f9e2a-03")));
+
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 0:3 / /proc rw - proc proc rw\n"
+            "3 1 8:2 / /srv/data ro - xfs /dev/sdz2 ro\n"
+            "4 1 0:4 / /sys/fs/cgroup rw - cgroup2 cgroup2 rw\n");
+    qt_storage_setStatFunction(fakeStat);
+    qt_storage_setDeviceLinkRoot(links.path());
+
+    const QList<QStorageInfo> volumes = QStorageInfo::mountedVolumes();
+
+    qt_storage_setDeviceLinkRoot(QString());
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+
+    QCOMPARE(volumes.size(), 2);
+    QCOMPARE(volumes.at(0).rootPath(), QStringLiteral("/"));
+    QCOMPARE(volumes.at(0).device(), QByteArray("/dev/sdz1"));
+    QCOMPARE(volumes.at(0).bytesTotal(), qint64(1000));
+    QCOMPARE(volumes.at(0).bytesAvailable(), qint64(500));
+    QVERIFY(!volumes.at(0).isReadOnly());
+    QCOMPARE(volumes.at(0).mountFlags(), QStorageInfo::MountFlags());
+    QCOMPARE(volumes.at(0).filesTotal(), qint64(100));
+    QCOMPARE(volumes.at(0).filesAvailable(), qint64(30));
+    QCOMPARE(volumes.at(0).fragmentSize(), 1024);
+    QVERIFY(volumes.at(0).name().isEmpty());
+    QVERIFY(volumes.at(0).uuid().isEmpty());
+    QVERIFY(volumes.at(0).partitionUuid().isEmpty());
+
+    QCOMPARE(volumes.at(1).rootPath(), QStringLiteral("/srv/data"));
+    QCOMPARE(volumes.at(1).fileSystemType(), QByteArray("xfs"));
+    QCOMPARE(volumes.at(1).bytesFree(), qint64(600));
+    QVERIFY(volumes.at(1).isReadOnly());
+    QCOMPARE(volumes.at(1).mountFlags(), QStorageInfo::ReadOnlyMount
+             | QStorageInfo::NoExecMount | QStorageInfo::NoAtimeMount);
+    QCOMPARE(volumes.at(1).filesFree(), qint64(40));
+    QCOMPARE(volumes.at(1).blockSize(), 4096);
+    QCOMPARE(volumes.at(1).maximumFileNameLength(), 255);
+    QCOMPARE(volumes.at(1).name(), QStringLiteral("DATA"));
+    QCOMPARE(volumes.at(1).uuid(), QByteArray("0e5a3b2c-7d14-4f3a-9c61-2b8e5f0d4a17"));
+    QCOMPARE(volumes.at(1).partitionUuid(), QByteArray("6c1f9e2a-03"));
+
+    // the real mount table is back
+    QVERIFY(QStorageInfo::mountedVolumes().contains(QStorageInfo::root()));
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+#if defined(Q_OS_LINUX)
+static QSemaphore slowVolumeRelease;
+
+static bool blockingStat(const QByteArray &rootPath, QStorageStatInfo *info)
+{
+    if (rootPath == "/srv/slow")
+        slowVolumeRelease.acquire();
+    return fakeStat(rootPath, info);
+}
+#endif
+
+void tst_QStorageInfo::slowVolume()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 8:3 / /srv/slow rw - xfs /dev/sdz3 rw\n");
+    qt_storage_setStatFunction(blockingStat);
+    QStorageInfo::setQueryTimeout(100);
+
+    QList<QStorageInfo> volumes;
+    QStorageInfo::forEachMountedVolume(appendVolume, &volumes, QStorageInfo::SkipVolumeInfo);
+    const bool rootReady = volumes.value(0).isReady();
+    const bool rootTimedOut = volumes.value(0).hasTimedOut();
+    const bool slowValid = volumes.value(1).isValid();
+    const bool slowReady = volumes.value(1).isReady();
+    const bool slowTimedOut = volumes.value(1).hasTimedOut();
+    const qint64 slowBytesTotal = volumes.value(1).bytesTotal();
+
+    // the worker is still waiting for the volume to answer
+    slowVolumeRelease.release();
+    QStorageInfo::setQueryTimeout(-1);
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+
+    QCOMPARE(volumes.size(), 2);
+    QVERIFY(rootReady);
+    QVERIFY(!rootTimedOut);
+    QVERIFY(slowValid);
+    QVERIFY(!slowReady);
+    QVERIFY(slowTimedOut);
+    QVERIFY(slowBytesTotal == -1);
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
 #endif
 
 QTEST_MAIN(tst_QStorageInfo)
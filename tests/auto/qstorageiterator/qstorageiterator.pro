@@ -0,0 +1,10 @@
+TEMPLATE = app
+QT += core testlib
+CONFIG -= app_bundle
+CONFIG += console
+
+SOURCES += tst_qstorageiterator.cpp
+INCLUDEPATH += $$PWD/../../../include
+LIBS += -L$$OUT_PWD/../../../lib -lqstorageinfo
+
+include($$PWD/../../../src/libs.pri)
@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtTest/QtTest>
+
+#include <QStorageInfo>
+#include <QStorageIterator>
+
+#if defined(Q_OS_LINUX)
+#include "../../../src/qstorageiterator_p.h"
+#endif
+
+class tst_QStorageIterator : public QObject
+{
+    Q_OBJECT
+private slots:
+    void iterate();
+    void matchesMountedVolumes();
+    void mountTableData();
+    void mountTableFile();
+};
+
+static const char mountTable[] =
+        "21 1 0:20 / /proc rw,nosuid - proc proc rw\n"
+        "1 0 8:1 / / rw,relatime shared:1 - ext4 /dev/sda1 rw,errors=remount-ro\n"
+        "35 1 8:2 /home/user /mnt/my\\040files rw shared:2 master:1 - btrfs /dev/sda2 rw\n"
+        "server:/export /net/export nfs4 ro,vers=4.2 0 0\n"
+        "\n"
+        "garbage\n";
+
+static void checkMountTable()
+{
+    QStorageIterator it;
+    QVERIFY(it.isValid());
+
+    QVERIFY(it.next());
+    QCOMPARE(it.rootPath(), "/proc");
+    QCOMPARE(it.fileSystemType(), "proc");
+
+    QVERIFY(it.next());
+    QCOMPARE(it.rootPath(), "/");
+    QCOMPARE(it.device(), "/dev/sda1");
+    QCOMPARE(it.fileSystemType(), "ext4");
+    QCOMPARE(it.options(), "rw,relatime");
+    QCOMPARE(it.superOptions(), "rw,errors=remount-ro");
+    QCOMPARE(it.optionalFields(), "shared:1");
+    QCOMPARE(it.mountId(), 1);
+    QCOMPARE(it.parentMountId(), 0);
+    QCOMPARE(it.majorDeviceNumber(), 8);
+    QCOMPARE(it.minorDeviceNumber(), 1);
+
+    QVERIFY(it.next());
+    QCOMPARE(it.rootPath(), "/mnt/my files");
+    QCOMPARE(it.fileSystemRoot(), "/home/user");
+    QCOMPARE(it.optionalFields(), "shared:2 master:1");
+
+    // lines in the format of /etc/mtab are accepted as well
+    QVERIFY(it.next());
+    QCOMPARE(it.rootPath(), "/net/export");
+    QCOMPARE(it.device(), "server:/export");
+    QCOMPARE(it.fileSystemType(), "nfs4");
+    QCOMPARE(it.options(), "ro,vers=4.2");
+    QCOMPARE(it.mountId(), -1);
+    QCOMPARE(it.fileSystemRoot(), "");
+
+    QVERIFY(!it.next());
+}
+
+void tst_QStorageIterator::iterate()
+{
+    QStorageIterator it;
+#if defined(Q_OS_WIN)
+    QVERIFY(!it.isValid());
+    QVERIFY(!it.next());
+#else
+    QVERIFY(it.isValid());
+
+    int count = 0;
+    while (it.next()) {
+        ++count;
+        QVERIFY(qstrlen(it.rootPath()) > 0);
+        QVERIFY(qstrlen(it.fileSystemType()) > 0);
+    }
+    QVERIFY(count > 0);
+    QVERIFY(!it.next());
+#endif
+}
+
+void tst_QStorageIterator::matchesMountedVolumes()
+{
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+    QSet<QString> mountPoints;
+    QStorageIterator it;
+    while (it.next())
+        mountPoints.insert(QFile::decodeName(it.rootPath()));
+
+    foreach (const QStorageInfo &storage, QStorageInfo::mountedVolumes())
+        QVERIFY2(mountPoints.contains(storage.rootPath()), qPrintable(storage.rootPath()));
+#else
+    QSKIP("QStorageInfo does not enumerate volumes through QStorageIterator on this platform");
+#endif
+}
+
+void tst_QStorageIterator::mountTableData()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setMountTableData(QByteArray(mountTable));
+    checkMountTable();
+    qt_storage_resetMountTable();
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+void tst_QStorageIterator::mountTableFile()
+{
+#if defined(Q_OS_LINUX)
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(mountTable), qint64(sizeof(mountTable) - 1));
+    file.close();
+
+    qt_storage_setMountTableFile(file.fileName());
+    checkMountTable();
+
+    qt_storage_setMountTableFile(file.fileName() + QStringLiteral(".missing"));
+    QVERIFY(!QStorageIterator().isValid());
+    qt_storage_resetMountTable();
+    QVERIFY(QStorageIterator().isValid());
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+QTEST_MAIN(tst_QStorageIterator)
+
+#include "tst_qstorageiterator.moc"
@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtTest/QtTest>
+
+#include <QStorageInfo>
+#include <QStorageSnapshot>
+
+#if defined(Q_OS_LINUX)
+#include "../../../src/qstorageinfo_p.h"
+#include "../../../src/qstorageiterator_p.h"
+#endif
+
+class tst_QStorageSnapshot : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup();
+
+    void empty();
+    void current();
+    void diff();
+    void skipVolumeInfo();
+};
+
+#if defined(Q_OS_LINUX)
+static qint64 rootBytesFree = 600;
+
+static bool fakeStat(const QByteArray &rootPath, QStorageStatInfo *info)
+{
+    info->bytesTotal = 1000;
+    info->bytesFree = rootPath == "/" ? rootBytesFree : 600;
+    info->bytesAvailable = 500;
+    return true;
+}
+
+static QStringList rootPaths(const QList<QStorageInfo> &volumes)
+{
+    QStringList result;
+    foreach (const QStorageInfo &volume, volumes)
+        result.append(volume.rootPath());
+    return result;
+}
+#endif
+
+void tst_QStorageSnapshot::cleanup()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+#endif
+}
+
+void tst_QStorageSnapshot::empty()
+{
+    const QStorageSnapshot snapshot;
+    QVERIFY(snapshot.isEmpty());
+    QCOMPARE(snapshot.size(), 0);
+    QVERIFY(snapshot.volumes().isEmpty());
+    QVERIFY(snapshot.diff(QStorageSnapshot()).isEmpty());
+}
+
+void tst_QStorageSnapshot::current()
+{
+    const QStorageSnapshot snapshot = QStorageSnapshot::current();
+    QVERIFY(!snapshot.isEmpty());
+    QCOMPARE(snapshot.volumes().size(), snapshot.size());
+    QVERIFY(snapshot.volumes().contains(QStorageInfo::root()));
+    QVERIFY(snapshot.diff(snapshot).isEmpty());
+
+    const QStorageSnapshot::Diff added = snapshot.diff(QStorageSnapshot());
+    QCOMPARE(added.added.size(), snapshot.size());
+    QVERIFY(added.removed.isEmpty());
+    QVERIFY(added.changed.isEmpty());
+
+    const QStorageSnapshot::Diff removed = QStorageSnapshot().diff(snapshot);
+    QCOMPARE(removed.removed.size(), snapshot.size());
+    QVERIFY(removed.added.isEmpty());
+    QVERIFY(removed.changed.isEmpty());
+}
+
+void tst_QStorageSnapshot::diff()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setStatFunction(fakeStat);
+    rootBytesFree = 600;
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 0:3 / /proc rw - proc proc rw\n"
+            "3 1 8:2 / /srv/data rw - xfs /dev/sdz2 rw\n"
+            "4 1 8:3 / /srv/old rw - ext4 /dev/sdz3 rw\n"
+            "6 1 8:5 / /srv/same rw - ext4 /dev/sdz5 rw\n");
+    const QStorageSnapshot first = QStorageSnapshot::current();
+    QCOMPARE(first.size(), 4);
+
+    rootBytesFree = 400;
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 0:3 / /proc rw - proc proc rw\n"
+            "3 1 8:2 / /srv/data ro - xfs /dev/sdz2 ro\n"
+            "6 1 8:5 / /srv/same rw - ext4 /dev/sdz5 rw\n"
+            "5 1 8:4 / /media/usb rw - vfat /dev/sdz4 rw\n");
+    const QStorageSnapshot second = QStorageSnapshot::current();
+    QCOMPARE(second.size(), 4);
+
+    const QStorageSnapshot::Diff diff = second.diff(first);
+    QVERIFY(!diff.isEmpty());
+    QCOMPARE(rootPaths(diff.added), QStringList() << QStringLiteral("/media/usb"));
+    QCOMPARE(rootPaths(diff.removed), QStringList() << QStringLiteral("/srv/old"));
+    QCOMPARE(rootPaths(diff.changed), QStringList() << QStringLiteral("/")
+                                                    << QStringLiteral("/srv/data"));
+
+    // changed volumes have the key of the volume they replace
+    QSet<QByteArray> firstKeys;
+    foreach (const QStorageInfo &volume, first.volumes())
+        firstKeys.insert(QStorageSnapshot::volumeKey(volume));
+    foreach (const QStorageInfo &volume, diff.changed)
+        QVERIFY(firstKeys.contains(QStorageSnapshot::volumeKey(volume)));
+    QVERIFY(!firstKeys.contains(QStorageSnapshot::volumeKey(diff.added.at(0))));
+
+    // nothing changed since
+    QVERIFY(QStorageSnapshot::current().diff(second).isEmpty());
+
+    // the same device on the same mount point, but mounted anew
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "3 1 8:2 / /srv/data ro - xfs /dev/sdz2 ro\n"
+            "7 1 8:5 / /srv/same rw - ext4 /dev/sdz5 rw\n"
+            "5 1 8:4 / /media/usb rw - vfat /dev/sdz4 rw\n");
+    const QStorageSnapshot::Diff remounted = QStorageSnapshot::current().diff(second);
+    QCOMPARE(rootPaths(remounted.added), QStringList() << QStringLiteral("/srv/same"));
+    QCOMPARE(rootPaths(remounted.removed), QStringList() << QStringLiteral("/srv/same"));
+    QVERIFY(QStorageSnapshot::volumeKey(remounted.added.at(0))
+            != QStorageSnapshot::volumeKey(remounted.removed.at(0)));
+    QVERIFY(remounted.changed.isEmpty());
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+void tst_QStorageSnapshot::skipVolumeInfo()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setStatFunction(fakeStat);
+    rootBytesFree = 600;
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "3 1 8:2 / /srv/data rw - xfs /dev/sdz2 rw\n");
+    const QStorageSnapshot first = QStorageSnapshot::current(QStorageInfo::SkipVolumeInfo);
+
+    // the space is not compared without the volume information
+    rootBytesFree = 400;
+    QVERIFY(QStorageSnapshot::current().diff(first).isEmpty());
+
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "3 1 8:2 / /srv/data ro - xfs /dev/sdz2 ro\n");
+    const QStorageSnapshot::Diff diff = QStorageSnapshot::current(QStorageInfo::SkipVolumeInfo).diff(first);
+    QVERIFY(diff.added.isEmpty());
+    QVERIFY(diff.removed.isEmpty());
+    QCOMPARE(rootPaths(diff.changed), QStringList() << QStringLiteral("/srv/data"));
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+QTEST_MAIN(tst_QStorageSnapshot)
+
+#include "tst_qstoragesnapshot.moc"
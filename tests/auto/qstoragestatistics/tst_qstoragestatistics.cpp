@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtTest/QtTest>
+
+#include <QStorageInfo>
+#include <QStorageStatistics>
+
+#if defined(Q_OS_LINUX)
+#include "../../../src/qstorageinfo_p.h"
+#include "../../../src/qstorageiterator_p.h"
+#endif
+
+class tst_QStorageStatistics : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup();
+
+    void defaultConstructed();
+    void latencyBuckets();
+    void disabledByDefault();
+    void counters();
+};
+
+void tst_QStorageStatistics::cleanup()
+{
+    QStorageInfo::setStatisticsEnabled(false);
+    QStorageInfo::resetStatistics();
+}
+
+void tst_QStorageStatistics::defaultConstructed()
+{
+    const QStorageStatistics statistics;
+    for (int i = 0; i < QStorageStatistics::CounterCount; ++i)
+        QCOMPARE(statistics.count(QStorageStatistics::Counter(i)), quint64(0));
+    for (int i = 0; i < QStorageStatistics::PhaseCount; ++i)
+        QCOMPARE(statistics.nsecsElapsed(QStorageStatistics::Phase(i)), qint64(0));
+    QVERIFY(statistics.statLatencyRootPaths().isEmpty());
+    QVERIFY(statistics.statLatencyHistogram(QStringLiteral("/")).isEmpty());
+}
+
+void tst_QStorageStatistics::latencyBuckets()
+{
+    QCOMPARE(QStorageStatistics::latencyBucketLimit(0), Q_INT64_C(10000));
+    QCOMPARE(QStorageStatistics::latencyBucketLimit(1), Q_INT64_C(100000));
+    QCOMPARE(QStorageStatistics::latencyBucketLimit(QStorageStatistics::LatencyBucketCount - 2),
+             Q_INT64_C(10000000000));
+    QCOMPARE(QStorageStatistics::latencyBucketLimit(QStorageStatistics::LatencyBucketCount - 1),
+             Q_INT64_C(-1));
+    QCOMPARE(QStorageStatistics::latencyBucketLimit(-1), Q_INT64_C(-1));
+}
+
+void tst_QStorageStatistics::disabledByDefault()
+{
+    QVERIFY(!QStorageInfo::isStatisticsEnabled());
+
+    QStorageInfo storage(QDir::currentPath());
+    QVERIFY(storage.isValid());
+    QVERIFY(storage.bytesTotal() >= 0);
+    QVERIFY(!QStorageInfo::mountedVolumes().isEmpty());
+
+    const QStorageStatistics statistics = QStorageInfo::statistics();
+    for (int i = 0; i < QStorageStatistics::CounterCount; ++i)
+        QCOMPARE(statistics.count(QStorageStatistics::Counter(i)), quint64(0));
+    QVERIFY(statistics.statLatencyRootPaths().isEmpty());
+}
+
+#if defined(Q_OS_LINUX)
+static bool fakeStat(const QByteArray &, QStorageStatInfo *info)
+{
+    info->bytesTotal = 1000;
+    info->bytesFree = 600;
+    info->bytesAvailable = 500;
+    return true;
+}
+
+static quint64 sum(const QVector<quint64> &histogram)
+{
+    quint64 result = 0;
+    foreach (quint64 count, histogram)
+        result += count;
+    return result;
+}
+#endif
+
+void tst_QStorageStatistics::counters()
+{
+#if defined(Q_OS_LINUX)
+    QTemporaryDir links;
+    QVERIFY(links.isValid());
+    QVERIFY(QDir(links.path()).mkdir(QStringLiteral("by-label")));
+    QVERIFY(QFile::link(QStringLiteral("/dev/sdz2"), links.path() + QStringLiteral("/by-label/DATA")));
+
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 0:3 / /proc rw - proc proc rw\n"
+            "3 1 8:2 / /srv/data rw - xfs /dev/sdz2 rw\n");
+    qt_storage_setStatFunction(fakeStat);
+    qt_storage_setDeviceLinkRoot(links.path());
+
+    QStorageInfo::setStatisticsEnabled(true);
+    QVERIFY(QStorageInfo::isStatisticsEnabled());
+    QStorageInfo::resetStatistics();
+
+    QCOMPARE(QStorageInfo::mountedVolumes().size(), 2);
+    const QStorageStatistics first = QStorageInfo::statistics();
+
+    QCOMPARE(QStorageInfo::mountedVolumes().size(), 2);
+    const QStorageStatistics second = QStorageInfo::statistics();
+
+    qt_storage_setDeviceLinkRoot(QString());
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+
+    // the table was set anew, so it is read once, with all of its entries
+    QCOMPARE(first.count(QStorageStatistics::MountEntriesParsed), quint64(3));
+    QCOMPARE(first.count(QStorageStatistics::StatCalls), quint64(2));
+    QVERIFY(first.count(QStorageStatistics::CacheMisses) >= 2);
+    QVERIFY(first.count(QStorageStatistics::LinksRead) >= 1);
+    QVERIFY(first.count(QStorageStatistics::FilesOpened) >= 3);
+    QVERIFY(first.nsecsElapsed(QStorageStatistics::MountTablePhase) >= 0);
+
+    QStringList rootPaths = first.statLatencyRootPaths();
+    rootPaths.sort();
+    QCOMPARE(rootPaths, QStringList() << QStringLiteral("/") << QStringLiteral("/srv/data"));
+    QCOMPARE(first.statLatencyHistogram(QStringLiteral("/")).size(),
+             int(QStorageStatistics::LatencyBucketCount));
+    QCOMPARE(sum(first.statLatencyHistogram(QStringLiteral("/srv/data"))), quint64(1));
+
+    // the second time the cached table is used
+    QCOMPARE(second.count(QStorageStatistics::MountEntriesParsed), quint64(3));
+    QVERIFY(second.count(QStorageStatistics::CacheHits) > first.count(QStorageStatistics::CacheHits));
+    QCOMPARE(second.count(QStorageStatistics::StatCalls), quint64(4));
+    QCOMPARE(sum(second.statLatencyHistogram(QStringLiteral("/"))), quint64(2));
+
+    QStorageInfo::resetStatistics();
+    const QStorageStatistics reset = QStorageInfo::statistics();
+    QCOMPARE(reset.count(QStorageStatistics::StatCalls), quint64(0));
+    QVERIFY(reset.statLatencyRootPaths().isEmpty());
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+QTEST_MAIN(tst_QStorageStatistics)
+
+#include "tst_qstoragestatistics.moc"
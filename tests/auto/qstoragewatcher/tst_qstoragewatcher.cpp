@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include <QtTest/QtTest>
+
+#include <QStorageWatcher>
+
+#if defined(Q_OS_LINUX)
+#include "../../../src/qstorageinfo_p.h"
+#include "../../../src/qstorageiterator_p.h"
+#endif
+
+class tst_QStorageWatcher : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void noSpuriousSignals();
+    void changes();
+    void spaceCheckInterval();
+    void spaceChanges();
+};
+
+void tst_QStorageWatcher::initTestCase()
+{
+    qRegisterMetaType<QStorageInfo>();
+}
+
+void tst_QStorageWatcher::noSpuriousSignals()
+{
+    QStorageWatcher watcher;
+    QSignalSpy mountedSpy(&watcher, SIGNAL(volumeMounted(QStorageInfo)));
+    QSignalSpy unmountedSpy(&watcher, SIGNAL(volumeUnmounted(QStorageInfo)));
+    QSignalSpy changedSpy(&watcher, SIGNAL(volumeChanged(QStorageInfo)));
+    QVERIFY(mountedSpy.isValid());
+    QVERIFY(unmountedSpy.isValid());
+    QVERIFY(changedSpy.isValid());
+
+    // nothing is mounted or unmounted by the test, so checking again has
+    // nothing to report
+    QVERIFY(QMetaObject::invokeMethod(&watcher, "_q_mountsChanged"));
+
+    QCOMPARE(mountedSpy.count(), 0);
+    QCOMPARE(unmountedSpy.count(), 0);
+    QCOMPARE(changedSpy.count(), 0);
+}
+
+void tst_QStorageWatcher::changes()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 8:2 / /srv/data rw - xfs /dev/sdz2 rw\n"
+            "3 1 8:3 / /srv/old rw - xfs /dev/sdz3 rw\n"
+            "4 1 0:3 / /proc rw - proc proc rw\n");
+
+    QStorageWatcher watcher;
+    QSignalSpy mountedSpy(&watcher, SIGNAL(volumeMounted(QStorageInfo)));
+    QSignalSpy unmountedSpy(&watcher, SIGNAL(volumeUnmounted(QStorageInfo)));
+    QSignalSpy changedSpy(&watcher, SIGNAL(volumeChanged(QStorageInfo)));
+
+    // /srv/data is remounted read-only, /srv/old is unmounted, /srv/new
+    // is mounted and a pseudo filesystem goes away unnoticed
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 8:2 / /srv/data ro - xfs /dev/sdz2 ro\n"
+            "5 1 8:4 / /srv/new rw - ext4 /dev/sdz4 rw\n");
+    const bool invoked = QMetaObject::invokeMethod(&watcher, "_q_mountsChanged");
+    qt_storage_resetMountTable();
+    QVERIFY(invoked);
+
+    QCOMPARE(unmountedSpy.count(), 1);
+    const QStorageInfo unmounted = unmountedSpy.at(0).at(0).value<QStorageInfo>();
+    QCOMPARE(unmounted.rootPath(), QStringLiteral("/srv/old"));
+    QCOMPARE(unmounted.device(), QByteArray("/dev/sdz3"));
+
+    QCOMPARE(mountedSpy.count(), 1);
+    const QStorageInfo mounted = mountedSpy.at(0).at(0).value<QStorageInfo>();
+    QCOMPARE(mounted.rootPath(), QStringLiteral("/srv/new"));
+    QCOMPARE(mounted.fileSystemType(), QByteArray("ext4"));
+
+    QCOMPARE(changedSpy.count(), 1);
+    const QStorageInfo changed = changedSpy.at(0).at(0).value<QStorageInfo>();
+    QCOMPARE(changed.rootPath(), QStringLiteral("/srv/data"));
+    QCOMPARE(changed.device(), QByteArray("/dev/sdz2"));
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+void tst_QStorageWatcher::spaceCheckInterval()
+{
+    QStorageWatcher watcher;
+    QCOMPARE(watcher.spaceCheckInterval(), 0);
+
+    watcher.setSpaceCheckInterval(5000);
+    QCOMPARE(watcher.spaceCheckInterval(), 5000);
+
+    watcher.setSpaceCheckInterval(0);
+    QCOMPARE(watcher.spaceCheckInterval(), 0);
+}
+
+#if defined(Q_OS_LINUX)
+static QBasicAtomicInt dataBytesFree = Q_BASIC_ATOMIC_INITIALIZER(600);
+
+static bool fakeStat(const QByteArray &rootPath, QStorageStatInfo *info)
+{
+    info->bytesTotal = 1000;
+    info->bytesFree = rootPath == "/srv/data" ? dataBytesFree.load() : 600;
+    info->bytesAvailable = info->bytesFree - 100;
+    return true;
+}
+#endif
+
+void tst_QStorageWatcher::spaceChanges()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setMountTableData(
+            "1 0 8:1 / / rw - ext4 /dev/sdz1 rw\n"
+            "2 1 8:2 / /srv/data rw - xfs /dev/sdz2 rw\n");
+    qt_storage_setStatFunction(fakeStat);
+    dataBytesFree.store(600);
+
+    QStorageWatcher watcher;
+    watcher.setSpaceCheckInterval(60000);
+    QSignalSpy spaceSpy(&watcher, SIGNAL(volumeSpaceChanged(QStorageInfo)));
+    QVERIFY(spaceSpy.isValid());
+
+    // the first check only records the space
+    QVERIFY(QMetaObject::invokeMethod(&watcher, "_q_checkSpace"));
+    QCOMPARE(spaceSpy.count(), 0);
+
+    dataBytesFree.store(400);
+    QVERIFY(QMetaObject::invokeMethod(&watcher, "_q_checkSpace"));
+    QCOMPARE(spaceSpy.count(), 1);
+    const QStorageInfo changed = spaceSpy.at(0).at(0).value<QStorageInfo>();
+    QCOMPARE(changed.rootPath(), QStringLiteral("/srv/data"));
+    QCOMPARE(changed.bytesFree(), qint64(400));
+    QCOMPARE(changed.bytesAvailable(), qint64(300));
+
+    QVERIFY(QMetaObject::invokeMethod(&watcher, "_q_checkSpace"));
+    QCOMPARE(spaceSpy.count(), 1);
+
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+#else
+    QSKIP("The mount table can only be replaced on Linux");
+#endif
+}
+
+QTEST_MAIN(tst_QStorageWatcher)
+
+#include "tst_qstoragewatcher.moc"
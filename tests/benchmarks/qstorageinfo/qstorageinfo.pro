@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = tst_bench_qstorageinfo
+QT += core testlib
+CONFIG -= app_bundle
+CONFIG += console
+
+SOURCES += tst_bench_qstorageinfo.cpp
+INCLUDEPATH += $$PWD/../../../include
+LIBS += -L$$OUT_PWD/../../../lib -lqstorageinfo
+
+include($$PWD/../../../src/libs.pri)
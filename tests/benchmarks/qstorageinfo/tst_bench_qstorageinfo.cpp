@@ -0,0 +1,403 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Ivan Komissarov <ABBAPOH@gmail.com>
+** Contact: http://www.qt.io/licensing/
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL21$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see http://www.qt.io/terms-conditions. For further
+** information use the contact form at http://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 or version 3 as published by the Free
+** Software Foundation and appearing in the file LICENSE.LGPLv21 and
+** LICENSE.LGPLv3 included in the packaging of this file. Please review the
+** following information to ensure the GNU Lesser General Public License
+** requirements will be met: https://www.gnu.org/licenses/lgpl.html and
+** http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** As a special exception, The Qt Company gives you certain additional
+** rights. These rights are described in The Qt Company LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <QStorageInfo>
+
+#if defined(Q_OS_LINUX)
+#include "../../../src/qstorageinfo_p.h"
+#include "../../../src/qstorageiterator_p.h"
+#endif
+
+class tst_QStorageInfo : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanup();
+
+    void construct_data();
+    void construct();
+    void setPathSameVolume_data();
+    void setPathSameVolume();
+    void setPathOtherVolume_data();
+    void setPathOtherVolume();
+    void mountedVolumes_data();
+    void mountedVolumes();
+    void refresh_data();
+    void refresh();
+    void refreshSpace();
+    void forPaths_data();
+    void forPaths();
+    void isRoot_data();
+    void isRoot();
+    void operatorEqual_data();
+    void operatorEqual();
+
+private:
+    QString useMountTable(int mounts);
+
+    QTemporaryDir mountDir;
+    int mountDirCount;
+};
+
+// The "system" rows use the mount table of the machine, the other ones a
+// synthetic table with that many mounts and a replaced statvfs(), so that
+// only the cost of QStorageInfo itself is measured.
+static QList<int> mountTableSizes()
+{
+    QList<int> sizes;
+    sizes << 0;
+#if defined(Q_OS_LINUX)
+    sizes << 10 << 100 << 1000 << 10000 << 20000;
+#endif
+    return sizes;
+}
+
+static QByteArray rowName(int mounts)
+{
+    return mounts ? QByteArray::number(mounts) : QByteArray("system");
+}
+
+static void addMountTableRows()
+{
+    QTest::addColumn<int>("mounts");
+    foreach (int mounts, mountTableSizes())
+        QTest::newRow(rowName(mounts).constData()) << mounts;
+}
+
+#if defined(Q_OS_LINUX)
+static bool fakeStat(const QByteArray &, QStorageStatInfo *info)
+{
+    info->bytesTotal = Q_INT64_C(1) << 40;
+    info->bytesFree = Q_INT64_C(1) << 39;
+    info->bytesAvailable = Q_INT64_C(1) << 38;
+    return true;
+}
+
+// escapes a path the way the kernel does in /proc/self/mountinfo
+static QByteArray escapedPath(const QString &path)
+{
+    QByteArray result;
+    foreach (char c, QFile::encodeName(path)) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\\')
+            result += '\\' + QByteArray::number(uchar(c), 8).rightJustified(3, '0');
+        else
+            result += c;
+    }
+    return result;
+}
+#endif
+
+void tst_QStorageInfo::initTestCase()
+{
+    QVERIFY(mountDir.isValid());
+    mountDirCount = 0;
+
+    // root() is created only once, make sure it is the real one
+    QVERIFY(QStorageInfo::root().isValid());
+}
+
+void tst_QStorageInfo::cleanup()
+{
+#if defined(Q_OS_LINUX)
+    qt_storage_setStatFunction(Q_NULLPTR);
+    qt_storage_resetMountTable();
+#endif
+}
+
+// Installs a synthetic table of \a mounts entries, one on / and the others on
+// directories below mountDir, and returns the directory in the middle. For
+// the system table an empty string is returned.
+QString tst_QStorageInfo::useMountTable(int mounts)
+{
+    if (mounts == 0)
+        return QString();
+
+#if defined(Q_OS_LINUX)
+    const QDir dir(mountDir.path());
+    for (; mountDirCount < mounts; ++mountDirCount)
+        dir.mkdir(QLatin1Char('d') + QString::number(mountDirCount));
+
+    const QByteArray prefix = escapedPath(mountDir.path()) + "/d";
+    QByteArray table = "1 0 1000:0 / / rw - ext4 /dev/synthetic0 rw\n";
+    for (int i = 1; i < mounts; ++i) {
+        const QByteArray number = QByteArray::number(i);
+        table += number + " 1 1000:" + number + " / " + prefix + number
+                + " rw - ext4 /dev/synthetic" + number + " rw\n";
+    }
+    qt_storage_setMountTableData(table);
+    qt_storage_setStatFunction(fakeStat);
+    return mountDir.path() + QStringLiteral("/d") + QString::number(mounts / 2);
+#else
+    return QString();
+#endif
+}
+
+void tst_QStorageInfo::construct_data()
+{
+    QTest::addColumn<int>("mounts");
+    QTest::addColumn<bool>("query");
+
+    foreach (int mounts, mountTableSizes()) {
+        QTest::newRow(rowName(mounts).constData()) << mounts << false;
+        QTest::newRow((rowName(mounts) + "+space").constData()) << mounts << true;
+    }
+}
+
+void tst_QStorageInfo::construct()
+{
+    QFETCH(int, mounts);
+    QFETCH(bool, query);
+
+    QString path = useMountTable(mounts);
+    if (path.isEmpty())
+        path = QCoreApplication::applicationFilePath();
+
+    QBENCHMARK {
+        QStorageInfo storage(path);
+        if (query)
+            storage.bytesAvailable();
+    }
+}
+
+void tst_QStorageInfo::setPathSameVolume_data()
+{
+    addMountTableRows();
+}
+
+void tst_QStorageInfo::setPathSameVolume()
+{
+    QFETCH(int, mounts);
+
+    QString path = useMountTable(mounts);
+    if (path.isEmpty())
+        path = mountDir.path();
+    // neither is the mount point itself, which setPath() would skip
+    const QString paths[] = { path + QStringLiteral("/."), path + QStringLiteral("/./.") };
+
+    QStorageInfo storage;
+    int i = 0;
+    QBENCHMARK {
+        storage.setPath(paths[++i & 1]);
+    }
+    QCOMPARE(storage.rootPath(), QStorageInfo(path).rootPath());
+}
+
+void tst_QStorageInfo::setPathOtherVolume_data()
+{
+    addMountTableRows();
+}
+
+void tst_QStorageInfo::setPathOtherVolume()
+{
+    QFETCH(int, mounts);
+
+    QStringList paths;
+    if (mounts > 0) {
+        paths << useMountTable(mounts) << mountDir.path() + QStringLiteral("/d1");
+    } else {
+        const QStorageInfo first = QStorageInfo::root();
+        foreach (const QStorageInfo &volume, QStorageInfo::mountedVolumes()) {
+            if (volume.isReady() && volume != first) {
+                paths << first.rootPath() << volume.rootPath();
+                break;
+            }
+        }
+        if (paths.isEmpty())
+            QSKIP("There is only one mounted volume");
+    }
+
+    QStorageInfo storage;
+    int i = 0;
+    QBENCHMARK {
+        storage.setPath(paths.at(++i & 1));
+    }
+    QVERIFY(storage.isValid());
+}
+
+void tst_QStorageInfo::mountedVolumes_data()
+{
+    addMountTableRows();
+}
+
+void tst_QStorageInfo::mountedVolumes()
+{
+    QFETCH(int, mounts);
+    useMountTable(mounts);
+
+    QList<QStorageInfo> volumes;
+    QBENCHMARK {
+        volumes = QStorageInfo::mountedVolumes();
+    }
+    QVERIFY(!volumes.isEmpty());
+    if (mounts > 0)
+        QCOMPARE(volumes.size(), mounts);
+}
+
+void tst_QStorageInfo::refresh_data()
+{
+    addMountTableRows();
+}
+
+void tst_QStorageInfo::refresh()
+{
+    QFETCH(int, mounts);
+
+    const QString path = useMountTable(mounts);
+    QStorageInfo storage = path.isEmpty() ? QStorageInfo::root() : QStorageInfo(path);
+    QBENCHMARK {
+        storage.refresh();
+    }
+    QVERIFY(storage.isValid());
+}
+
+void tst_QStorageInfo::refreshSpace()
+{
+    QStorageInfo storage = QStorageInfo::root();
+    QBENCHMARK {
+        storage.refreshSpace();
+    }
+    QVERIFY(storage.isValid());
+}
+
+void tst_QStorageInfo::forPaths_data()
+{
+    QTest::addColumn<int>("mounts");
+    QTest::addColumn<int>("count");
+
+    static const int counts[] = { 1000, 100000, 1000000 };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        const QByteArray count = QByteArray::number(counts[i]);
+        QTest::newRow(count.constData()) << 0 << counts[i];
+#if defined(Q_OS_LINUX)
+        // the paths spread over all volumes of a synthetic table
+        QTest::newRow((count + "/50 volumes").constData()) << 50 << counts[i];
+#endif
+    }
+}
+
+void tst_QStorageInfo::forPaths()
+{
+    QFETCH(int, mounts);
+    QFETCH(int, count);
+
+    // the paths are on one real volume, or round robin on the mount points
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QStringList roots;
+    if (mounts) {
+        useMountTable(mounts);
+        for (int i = 0; i < mounts; ++i)
+            roots.append(mountDir.path() + QStringLiteral("/d") + QString::number(i));
+    } else {
+        roots.append(dir.path());
+    }
+
+    // distinct, existing paths: "A/../B" combinations of the directories
+    // below each root
+    const int directoryCount = mounts ? 200 : 1000;
+    foreach (const QString &root, roots) {
+        for (int i = 0; i < directoryCount; ++i)
+            QVERIFY(QDir(root).mkpath(QString::number(i)));
+    }
+
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const int combination = i / roots.size();
+        paths.append(roots.at(i % roots.size()) + QLatin1Char('/')
+                     + QString::number(combination % directoryCount) + QStringLiteral("/../")
+                     + QString::number(combination / directoryCount % directoryCount));
+    }
+
+    QHash<QString, QStorageInfo> volumes;
+    QBENCHMARK {
+        volumes = QStorageInfo::forPaths(paths);
+    }
+    QCOMPARE(volumes.size(), count);
+    if (mounts) {
+        QSet<QString> rootPaths;
+        foreach (const QStorageInfo &volume, volumes)
+            rootPaths.insert(volume.rootPath());
+        QCOMPARE(rootPaths.size(), mounts);
+    }
+}
+
+void tst_QStorageInfo::isRoot_data()
+{
+    addMountTableRows();
+}
+
+void tst_QStorageInfo::isRoot()
+{
+    QFETCH(int, mounts);
+
+    QString path = useMountTable(mounts);
+    if (path.isEmpty())
+        path = QCoreApplication::applicationDirPath();
+
+    const QStorageInfo storage(path);
+    bool result = false;
+    QBENCHMARK {
+        result = storage.isRoot();
+    }
+    QCOMPARE(result, storage.device() == QStorageInfo::root().device());
+}
+
+void tst_QStorageInfo::operatorEqual_data()
+{
+    addMountTableRows();
+}
+
+void tst_QStorageInfo::operatorEqual()
+{
+    QFETCH(int, mounts);
+
+    QString path = useMountTable(mounts);
+    if (path.isEmpty())
+        path = QCoreApplication::applicationDirPath();
+
+    const QStorageInfo first(path);
+    const QStorageInfo second(QDir::rootPath());
+    bool result = false;
+    QBENCHMARK {
+        result = first == second;
+    }
+    QCOMPARE(result, first.device() == second.device());
+}
+
+QTEST_MAIN(tst_QStorageInfo)
+
+#include "tst_bench_qstorageinfo.moc"